@@ -0,0 +1,85 @@
+// demo-evaluator-benchmark.cxx //
+// Author: Sanshiro Enomoto <sanshiro@uw.edu> //
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <kebap/Kebap.h>
+
+using namespace std;
+using namespace kebap;
+
+
+// counts heap allocations, to see what an evaluation costs besides arithmetic //
+static long gNumberOfAllocations = 0;
+
+void* operator new(size_t Size)
+{
+    gNumberOfAllocations++;
+    void* Pointer = malloc(Size > 0 ? Size : 1);
+    if (! Pointer) {
+        throw bad_alloc();
+    }
+    return Pointer;
+}
+
+void operator delete(void* Pointer) noexcept
+{
+    free(Pointer);
+}
+
+void operator delete(void* Pointer, size_t) noexcept
+{
+    free(Pointer);
+}
+
+
+
+int main(int argc, char** argv)
+{
+    long NumberOfEvaluations = (argc > 1) ? atol(argv[1]) : 1000000;
+
+    const char* ExpressionList[] = {
+        "x + 273.15",
+        "0.5*x*x - 3*x + 1",
+        "A * exp(-x/pi) * sin(2*pi*x) + B",
+        "sqrt(abs(x)) * 2 + 1",
+        "(x > 10) && (x < 20)",
+        "(long) x % 7",
+    };
+
+    cout << setw(40) << left << "expression" << right;
+    cout << setw(16) << "allocs/eval" << setw(16) << "ns/eval" << endl;
+
+    try {
+        for (const char* Expression: ExpressionList) {
+            KPEvaluator f(Expression);
+            f["A"] = 10;
+            f["B"] = 3;
+            f(0);  // parse
+
+            double Sum = 0;
+            long NumberOfAllocations = gNumberOfAllocations;
+            auto Start = chrono::steady_clock::now();
+            for (long i = 0; i < NumberOfEvaluations; i++) {
+                Sum += f(i * 1e-3);
+            }
+            auto Stop = chrono::steady_clock::now();
+            NumberOfAllocations = gNumberOfAllocations - NumberOfAllocations;
+
+            double Time = chrono::duration<double, nano>(Stop - Start).count();
+            cout << setw(40) << left << Expression << right;
+            cout << setw(16) << (double) NumberOfAllocations / NumberOfEvaluations;
+            cout << setw(16) << Time / NumberOfEvaluations;
+            cout << "    (" << Sum << ")" << endl;
+        }
+    }
+    catch (KPException &e) {
+        cerr << "ERROR: " << e.what() << endl;
+        return -1;
+    }
+
+    return 0;
+}
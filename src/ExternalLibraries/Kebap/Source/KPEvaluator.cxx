@@ -13,6 +13,16 @@ using namespace std;
 using namespace kebap;
 
 
+KPVariableSet::KPVariableSet(const std::vector<std::string>& NameList)
+{
+    KPNameTable* NameTable = KPNameTable::GetInstance();
+    for (const auto& Name: NameList) {
+        fIdList.push_back(NameTable->NameToId(Name));
+    }
+}
+
+
+
 KPEvaluator::KPEvaluator(const std::string& Expression)
 {
     fExpressionString = Expression;
@@ -48,6 +58,26 @@ KPEvaluator::~KPEvaluator()
     delete fTokenTable;
 }
 
+KPEvaluator* KPEvaluator::Clone() const
+{
+    // Evaluators hold evaluation state (parse tree node values and variables);
+    // a clone has its own state and can be used in a different thread.
+    KPEvaluator* Evaluator = new KPEvaluator(fExpressionString);
+    Evaluator->CopyParametersFrom(*this);
+
+    return Evaluator;
+}
+
+void KPEvaluator::CopyParametersFrom(const KPEvaluator& Source)
+{
+    for (long ParameterId: Source.fParameterIdList) {
+        KPValue* Parameter = Source.fSymbolTable->GetVariable(ParameterId);
+        if (Parameter) {
+            GetVariable(ParameterId)->Assign(*Parameter);
+        }
+    }
+}
+
 void KPEvaluator::SetParameter(const std::string& Name, double Value)
 {
     GetVariable(Name)->AssignDouble(Value);
@@ -55,29 +85,60 @@ void KPEvaluator::SetParameter(const std::string& Name, double Value)
 
 KPValue* KPEvaluator::GetVariable(const std::string& Name)
 {
-    long VariableId = fSymbolTable->NameToId(Name);
+    return GetVariable(fSymbolTable->NameToId(Name));
+}
+
+KPValue* KPEvaluator::GetVariable(long VariableId)
+{
     KPValue* Variable = fSymbolTable->GetVariable(VariableId);
 
     if (! Variable) {
         Variable = new KPValue(0.0);
         fSymbolTable->RegisterVariable(VariableId, Variable);
+        fParameterIdList.push_back(VariableId);
+        if (fExpression) {
+            fExpression->BindSlots(fSymbolTable);
+        }
     }
     
     return Variable;
 }
 
+vector<KPEvaluator::TParameterAccessor> KPEvaluator::Bind(const KPVariableSet& VariableSet)
+{
+    vector<TParameterAccessor> AccessorList;
+    AccessorList.reserve(VariableSet.Size());
+    for (unsigned i = 0; i < VariableSet.Size(); i++) {
+        AccessorList.emplace_back(GetVariable(VariableSet.IdOf(i)));
+    }
+
+    return AccessorList;
+}
+
+void KPEvaluator::Compile() 
+{
+    if (fExpression) {
+        return;
+    }
+    
+    istringstream is(fExpressionString);
+    KPTokenizer tokenizer(is, fTokenTable);
+    try {
+        fExpression = fExpressionParser->Parse(&tokenizer, fSymbolTable);
+    }
+    catch (KPException &e) {
+        fExpression = new KPLiteralNode(KPValue(0.0));
+        throw e;
+    }
+
+    // variables are global in the evaluator; bind them to the symbol-table slots //
+    fExpression->BindSlots(fSymbolTable);
+}
+
 double KPEvaluator::Evaluate(double X) 
 {
     if (! fExpression) {
-        istringstream is(fExpressionString);
-        KPTokenizer tokenizer(is, fTokenTable);
-        try {
-            fExpression = fExpressionParser->Parse(&tokenizer, fSymbolTable);
-        }
-        catch (KPException &e) {
-            fExpression = new KPLiteralNode(KPValue(0.0));
-            throw e;
-        }
+        Compile();
     }
 
     fVariableX->AssignDouble(X);
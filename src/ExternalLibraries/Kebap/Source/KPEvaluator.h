@@ -5,6 +5,7 @@
 #define __KPEvaluator_h__
 
 #include <string>
+#include <vector>
 #include "KPException.h"
 
 
@@ -20,6 +21,17 @@ class KPExpression;
 class KPValue;
 
 
+// Names resolved to variable IDs once, to be bound to evaluators without string lookups //
+class KPVariableSet {
+  public:
+    KPVariableSet(const std::vector<std::string>& NameList);
+    unsigned Size() const { return fIdList.size(); }
+    long IdOf(unsigned Index) const { return fIdList[Index]; }
+  protected:
+    std::vector<long> fIdList;
+};
+
+
 class KPEvaluator {
   public:
     class TParameterAccessor {
@@ -37,15 +49,23 @@ class KPEvaluator {
   public:
     KPEvaluator(const std::string& Expression);
     virtual ~KPEvaluator();
+    virtual KPEvaluator* Clone() const;
+    const std::string& ExpressionString() const { return fExpressionString; }
+    virtual void Compile() ;
     virtual double Evaluate(double X) ;
     virtual void SetParameter(const std::string& Name, double Value);
     virtual KPValue* GetVariable(const std::string& Name);
+    virtual KPValue* GetVariable(long VariableId);
+    // accessors returned here are handles to the variables, valid during the evaluator lifetime //
+    virtual std::vector<TParameterAccessor> Bind(const KPVariableSet& VariableSet);
     inline double operator()(double X)  { 
         return Evaluate(X); 
     }
     inline TParameterAccessor operator[](const std::string& Name) {
         return TParameterAccessor(GetVariable(Name));
     }
+  protected:
+    virtual void CopyParametersFrom(const KPEvaluator& Source);
   protected:
     KPTokenTable *fTokenTable;
     KPOperatorTable *fOperatorTable;
@@ -57,6 +77,7 @@ class KPEvaluator {
     std::string fExpressionString;
     KPExpression* fExpression;
     KPValue* fVariableX;
+    std::vector<long> fParameterIdList;
 };
 
 
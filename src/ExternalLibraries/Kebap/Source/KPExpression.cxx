@@ -413,6 +413,16 @@ KPExpression::~KPExpression()
     delete fRightNode;
 }
     
+void KPExpression::BindSlots(KPSymbolTable* SymbolTable)
+{
+    if (fLeftNode) {
+        fLeftNode->BindSlots(SymbolTable);
+    }
+    if (fRightNode) {
+        fRightNode->BindSlots(SymbolTable);
+    }
+}
+
 void KPExpression::SetLineNumber(long LineNumber)
 {
     fLineNumber = LineNumber;
@@ -609,6 +619,7 @@ void KPLiteralNode::DumpThis(ostream &os) const
 KPVariableNode::KPVariableNode(long VariableId)
 {
     fVariableId = VariableId;
+    fSlot = -1;
 }
 
 KPVariableNode::~KPVariableNode()
@@ -617,7 +628,10 @@ KPVariableNode::~KPVariableNode()
 
 KPValue& KPVariableNode::Evaluate(KPSymbolTable* SymbolTable) 
 {
-    KPValue* Variable = SymbolTable->GetVariable(fVariableId);
+    KPValue* Variable = SymbolTable->GetVariableAt(fSlot, fVariableId);
+    if (Variable == nullptr) {
+        Variable = SymbolTable->GetVariable(fVariableId);
+    }
     if (Variable == nullptr) {
         string Name = SymbolTable->IdToName(fVariableId);
         throw KPException() << Position() << "undefined variable: " << Name;
@@ -626,6 +640,11 @@ KPValue& KPVariableNode::Evaluate(KPSymbolTable* SymbolTable)
     return *Variable;
 }
 
+void KPVariableNode::BindSlots(KPSymbolTable* SymbolTable)
+{
+    fSlot = SymbolTable->FindSlot(fVariableId);
+}
+
 void KPVariableNode::DumpThis(ostream &os) const
 {
     os << KPNameTable::GetInstance()->IdToName(fVariableId);
@@ -668,6 +687,16 @@ KPValue& KPListNode::Evaluate(KPSymbolTable* SymbolTable)
     return fValue;
 }
 
+void KPListNode::BindSlots(KPSymbolTable* SymbolTable)
+{
+    for (unsigned i = 0; i < fKeyExpressionList.size(); i++) {
+        if (fKeyExpressionList[i]) {
+            fKeyExpressionList[i]->BindSlots(SymbolTable);
+        }
+        fValueExpressionList[i]->BindSlots(SymbolTable);
+    }
+}
+
 void KPListNode::DumpThis(ostream &os) const
 {
     os << "list[" << fValueExpressionList.size() << "]";
@@ -782,6 +811,13 @@ KPValue& KPFunctionCallNode::EvaluateObjectFunction(KPValue* Variable, KPSymbolT
     );
 }
 
+void KPFunctionCallNode::BindSlots(KPSymbolTable* SymbolTable)
+{
+    for (unsigned i = 0; i < fArgumentExpressionList.size(); i++) {
+        fArgumentExpressionList[i]->BindSlots(SymbolTable);
+    }
+}
+
 void KPFunctionCallNode::DumpThis(ostream &os) const
 {
     string FunctionName = KPNameTable::GetInstance()->IdToName(fFunctionId);
@@ -845,6 +881,12 @@ KPValue& KPMethodInvocationNode::Evaluate(KPSymbolTable* SymbolTable)
     return fValue;
 }
 
+void KPMethodInvocationNode::BindSlots(KPSymbolTable* SymbolTable)
+{
+    fObjectExpression->BindSlots(SymbolTable);
+    KPFunctionCallNode::BindSlots(SymbolTable);
+}
+
 
 
 KPPropertyAccessNode::KPPropertyAccessNode(KPExpression* ObjectExpression, const string& PropertyName)
@@ -896,6 +938,11 @@ KPValue& KPPropertyAccessNode::Evaluate(KPSymbolTable* SymbolTable)
     return fValue;
 }
 
+void KPPropertyAccessNode::BindSlots(KPSymbolTable* SymbolTable)
+{
+    fObjectExpression->BindSlots(SymbolTable);
+}
+
 void KPPropertyAccessNode::DumpThis(ostream &os) const
 {
     os << "." << fPropertyName;
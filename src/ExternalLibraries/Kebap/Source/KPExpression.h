@@ -47,6 +47,7 @@ class KPExpression {
     KPExpression();
     virtual ~KPExpression();
     virtual KPValue& Evaluate(KPSymbolTable* SymbolTable)  = 0;
+    virtual void BindSlots(KPSymbolTable* SymbolTable);
     virtual void Dump(std::ostream &os, int IndentLevel = 0) const;
     virtual void SetLineNumber(long LineNumber);
     virtual std::string Position() const;
@@ -103,10 +104,12 @@ class KPVariableNode: public KPExpression {
     KPVariableNode(long VariableId);
     ~KPVariableNode() override;
     KPValue& Evaluate(KPSymbolTable* SymbolTable) override ;
+    void BindSlots(KPSymbolTable* SymbolTable) override;
   protected:
     void DumpThis(std::ostream &os) const override;
   protected:
     long fVariableId;
+    long fSlot;
 };
 
 
@@ -115,6 +118,7 @@ class KPListNode: public KPExpression {
     KPListNode(const std::vector<KPExpression*>& KeyExpressionList, const std::vector<KPExpression*>& ValueExpressionList);
     ~KPListNode() override;
     KPValue& Evaluate(KPSymbolTable* SymbolTable) override ;
+    void BindSlots(KPSymbolTable* SymbolTable) override;
   protected:
     void DumpThis(std::ostream &os) const override;
   protected:
@@ -129,6 +133,7 @@ class KPFunctionCallNode: public KPExpression {
     KPFunctionCallNode(long FunctionId, std::vector<KPExpression*>& ArgumentExpressionList);
     ~KPFunctionCallNode() override;
     KPValue& Evaluate(KPSymbolTable* SymbolTable) override ;
+    void BindSlots(KPSymbolTable* SymbolTable) override;
   public:
     virtual void EvaluateArguments(KPSymbolTable* SymbolTable) ;
     virtual KPValue& EvaluateFunction(KPSymbolTable* SymbolTable) ;
@@ -149,6 +154,7 @@ class KPMethodInvocationNode: public KPFunctionCallNode {
     KPMethodInvocationNode(KPExpression* ObjectExpression, long FunctionId, std::vector<KPExpression*>& ArgumentExpressionList);
     ~KPMethodInvocationNode() override;
     KPValue& Evaluate(KPSymbolTable* SymbolTable) override ;
+    void BindSlots(KPSymbolTable* SymbolTable) override;
   protected:
     int fMethodId;
     std::string fMethodName;
@@ -164,6 +170,7 @@ class KPPropertyAccessNode: public KPExpression {
     KPPropertyAccessNode(KPExpression* ObjectExpression, const std::string& PropertyName);
     ~KPPropertyAccessNode() override;
     KPValue& Evaluate(KPSymbolTable* SymbolTable) override ;
+    void BindSlots(KPSymbolTable* SymbolTable) override;
   protected:
     void DumpThis(std::ostream &os) const override;
   protected:
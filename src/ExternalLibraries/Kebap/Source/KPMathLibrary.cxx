@@ -213,7 +213,7 @@ int KPMathObject::Sin(std::vector<KPValue*>& ArgumentList, KPValue& ReturnValue)
 	ReturnValue = KPValue(sin(ArgumentList[0]->AsComplex()));
     }
     else {
-	ReturnValue = KPValue(sin(ArgumentList[0]->AsDouble()));
+	ReturnValue.SetDouble(sin(ArgumentList[0]->AsDouble()));
     }
 
     return 1;
@@ -229,7 +229,7 @@ int KPMathObject::Cos(std::vector<KPValue*>& ArgumentList, KPValue& ReturnValue)
 	ReturnValue = KPValue(cos(ArgumentList[0]->AsComplex()));
     }
     else {
-	ReturnValue = KPValue(cos(ArgumentList[0]->AsDouble()));
+	ReturnValue.SetDouble(cos(ArgumentList[0]->AsDouble()));
     }
 
     return 1;
@@ -251,7 +251,7 @@ int KPMathObject::Tan(std::vector<KPValue*>& ArgumentList, KPValue& ReturnValue)
 	if (cos(ArgumentList[0]->AsDouble()) == 0) {
 	    throw KPException() << "tan(): invalid argument";
 	}
-	ReturnValue = KPValue(tan(ArgumentList[0]->AsDouble()));
+	ReturnValue.SetDouble(tan(ArgumentList[0]->AsDouble()));
     }
 
     return 1;
@@ -269,7 +269,7 @@ int KPMathObject::Asin(std::vector<KPValue*>& ArgumentList, KPValue& ReturnValue
     if ((x < -1.0) || (x > 1.0)) {
 	throw KPException() << "asin(): invalid argument";
     }
-    ReturnValue = KPValue(asin(x));
+    ReturnValue.SetDouble(asin(x));
 
     return 1;
 }
@@ -286,7 +286,7 @@ int KPMathObject::Acos(std::vector<KPValue*>& ArgumentList, KPValue& ReturnValue
     if ((x < -1.0) || (x > 1.0)) {
 	throw KPException() << "acos(): invalid argument";
     }
-    ReturnValue = KPValue(acos(x));
+    ReturnValue.SetDouble(acos(x));
 
     return 1;
 }
@@ -299,7 +299,7 @@ int KPMathObject::Atan(std::vector<KPValue*>& ArgumentList, KPValue& ReturnValue
     
     // no atan(complex) available in the standard library //
 
-    ReturnValue = KPValue(atan(ArgumentList[0]->AsDouble()));
+    ReturnValue.SetDouble(atan(ArgumentList[0]->AsDouble()));
 
     return 1;
 }
@@ -349,7 +349,7 @@ int KPMathObject::Exp(std::vector<KPValue*>& ArgumentList, KPValue& ReturnValue)
 	ReturnValue = KPValue(exp(ArgumentList[0]->AsComplex()));
     }
     else {
-	ReturnValue = KPValue(exp(ArgumentList[0]->AsDouble()));
+	ReturnValue.SetDouble(exp(ArgumentList[0]->AsDouble()));
     }
 
     return 1;
@@ -369,7 +369,7 @@ int KPMathObject::Log(std::vector<KPValue*>& ArgumentList, KPValue& ReturnValue)
 	if (x <= 0) {
 	    throw KPException() << "log(): invalid argument";
 	}
-	ReturnValue = KPValue(log(x));
+	ReturnValue.SetDouble(log(x));
     }
 
     return 1;
@@ -389,7 +389,7 @@ int KPMathObject::Log10(std::vector<KPValue*>& ArgumentList, KPValue& ReturnValu
 	if (x <= 0) {
 	    throw KPException() << "log10(): invalid argument";
 	}
-	ReturnValue = KPValue(log10(x));
+	ReturnValue.SetDouble(log10(x));
     }
 
     return 1;
@@ -409,7 +409,7 @@ int KPMathObject::Sqrt(std::vector<KPValue*>& ArgumentList, KPValue& ReturnValue
 	if (x < 0) {
 	    throw KPException() << "sqrt(): invalid argument";
 	}
-	ReturnValue = KPValue((double) sqrt(x));
+	ReturnValue.SetDouble(sqrt(x));
     }
 
     return 1;
@@ -428,7 +428,7 @@ int KPMathObject::Abs(std::vector<KPValue*>& ArgumentList, KPValue& ReturnValue)
 	ReturnValue = KPValue((long) abs(ArgumentList[0]->AsLong()));
     }
     else {
-	ReturnValue = KPValue(fabs(ArgumentList[0]->AsDouble()));
+	ReturnValue.SetDouble(fabs(ArgumentList[0]->AsDouble()));
     }
 
     return 1;
@@ -497,7 +497,7 @@ int KPMathObject::Round(std::vector<KPValue*>& ArgumentList, KPValue& ReturnValu
         throw KPException() << "round(): invalid argument";
     }
 
-    ReturnValue = KPValue(round(ArgumentList[0]->AsDouble()));
+    ReturnValue.SetDouble(round(ArgumentList[0]->AsDouble()));
 
     return 1;
 }
@@ -512,7 +512,7 @@ int KPMathObject::Trunc(std::vector<KPValue*>& ArgumentList, KPValue& ReturnValu
         throw KPException() << "trunc(): invalid argument";
     }
 
-    ReturnValue = KPValue(trunc(ArgumentList[0]->AsDouble()));
+    ReturnValue.SetDouble(trunc(ArgumentList[0]->AsDouble()));
 
     return 1;
 }
@@ -527,7 +527,7 @@ int KPMathObject::Ceil(std::vector<KPValue*>& ArgumentList, KPValue& ReturnValue
         throw KPException() << "ceil(): invalid argument";
     }
 
-    ReturnValue = KPValue(ceil(ArgumentList[0]->AsDouble()));
+    ReturnValue.SetDouble(ceil(ArgumentList[0]->AsDouble()));
 
     return 1;
 }
@@ -542,7 +542,7 @@ int KPMathObject::Floor(std::vector<KPValue*>& ArgumentList, KPValue& ReturnValu
         throw KPException() << "floor(): invalid argument";
     }
 
-    ReturnValue = KPValue(floor(ArgumentList[0]->AsDouble()));
+    ReturnValue.SetDouble(floor(ArgumentList[0]->AsDouble()));
 
     return 1;
 }
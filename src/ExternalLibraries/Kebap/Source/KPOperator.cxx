@@ -1137,7 +1137,7 @@ KPValue& KPOperatorNot::Evaluate(KPValue& Left, KPValue& Right, KPSymbolTable* S
 	return Result;
     }
 
-    return Result = KPValue(! Right.AsBool());
+    return Result.SetBool(! Right.AsBool());
 } 
 
 
@@ -1191,7 +1191,7 @@ KPValue& KPOperatorMultiple::Evaluate(KPValue& Left, KPValue& Right, KPSymbolTab
         (Left.IsReal() && Right.IsDouble()) ||
         (Left.IsDouble() && Right.IsReal())
     ){
-        return Result = KPValue(Left.AsDouble() * Right.AsDouble());
+        return Result.SetDouble(Left.AsDouble() * Right.AsDouble());
     }
 
     if (Left.IsList() || Right.IsList()) {
@@ -1207,10 +1207,10 @@ KPValue& KPOperatorMultiple::Evaluate(KPValue& Left, KPValue& Right, KPSymbolTab
         Result = KPValue(Left.AsComplex() * Right.AsComplex());
     }
     else if (Left.IsDouble() || Right.IsDouble()) {
-        Result = KPValue(Left.AsDouble() * Right.AsDouble());
+        Result.SetDouble(Left.AsDouble() * Right.AsDouble());
     }
     else {
-        Result = KPValue(Left.AsLong() * Right.AsLong());
+        Result.SetLong(Left.AsLong() * Right.AsLong());
     }
 
     return Result;
@@ -1243,7 +1243,7 @@ KPValue& KPOperatorDivide::Evaluate(KPValue& Left, KPValue& Right, KPSymbolTable
 	if (Right.AsDouble() == 0) {
 	    throw KPException() << "divide by zero";
 	}
-        return Result = KPValue(Left.AsDouble() / Right.AsDouble());
+        return Result.SetDouble(Left.AsDouble() / Right.AsDouble());
     }
 
     if (Left.IsList() || Right.IsList()) {
@@ -1265,13 +1265,13 @@ KPValue& KPOperatorDivide::Evaluate(KPValue& Left, KPValue& Right, KPSymbolTable
 	if (Right.AsDouble() == 0) {
 	    throw KPException() << "divide by zero";
 	}
-        Result = KPValue(Left.AsDouble() / Right.AsDouble());
+        Result.SetDouble(Left.AsDouble() / Right.AsDouble());
     }
     else {
 	if (Right.AsLong() == 0) {
 	    throw KPException() << "divide by zero";
 	}
-        Result = KPValue(Left.AsLong() / Right.AsLong());
+        Result.SetLong(Left.AsLong() / Right.AsLong());
     }
 
     return Result;
@@ -1340,7 +1340,7 @@ KPValue& KPOperatorAdd::Evaluate(KPValue& Left, KPValue& Right, KPSymbolTable* S
         (Left.IsReal() && Right.IsDouble()) ||
         (Left.IsDouble() && Right.IsReal())
     ){
-        return Result = KPValue(Left.AsDouble() + Right.AsDouble());
+        return Result.SetDouble(Left.AsDouble() + Right.AsDouble());
     }
 
     if (Left.IsVoid()) {
@@ -1374,10 +1374,10 @@ KPValue& KPOperatorAdd::Evaluate(KPValue& Left, KPValue& Right, KPSymbolTable* S
         Result = KPValue(Left.AsComplex() + Right.AsComplex());
     }
     else if (Left.IsDouble() || Right.IsDouble()) {
-        Result = KPValue(Left.AsDouble() + Right.AsDouble());
+        Result.SetDouble(Left.AsDouble() + Right.AsDouble());
     }
     else {
-        Result = KPValue(Left.AsLong() + Right.AsLong());
+        Result.SetLong(Left.AsLong() + Right.AsLong());
     }
 
     return Result;
@@ -1407,7 +1407,7 @@ KPValue& KPOperatorSubtract::Evaluate(KPValue& Left, KPValue& Right, KPSymbolTab
         (Left.IsReal() && Right.IsDouble()) ||
         (Left.IsDouble() && Right.IsReal())
     ){
-        return Result = KPValue(Left.AsDouble() - Right.AsDouble());
+        return Result.SetDouble(Left.AsDouble() - Right.AsDouble());
     }
 
     if (Left.IsList() || Right.IsList()) {
@@ -1431,10 +1431,10 @@ KPValue& KPOperatorSubtract::Evaluate(KPValue& Left, KPValue& Right, KPSymbolTab
         Result = KPValue(Left.AsComplex() - Right.AsComplex());
     }
     else if (Left.IsDouble() || Right.IsDouble()) {
-        Result = KPValue(Left.AsDouble() - Right.AsDouble());
+        Result.SetDouble(Left.AsDouble() - Right.AsDouble());
     }
     else {
-        Result = KPValue(Left.AsLong() - Right.AsLong());
+        Result.SetLong(Left.AsLong() - Right.AsLong());
     }
 
     return Result;
@@ -1503,7 +1503,7 @@ KPValue& KPOperatorLeftShift::Evaluate(KPValue& Left, KPValue& Right, KPSymbolTa
 	return Result;
     }
 
-    return Result = KPValue((long) (Left.AsLong() << Right.AsLong()));
+    return Result.SetLong((Left.AsLong() << Right.AsLong()));
 } 
 
 
@@ -1530,7 +1530,7 @@ KPValue& KPOperatorRightShift::Evaluate(KPValue& Left, KPValue& Right, KPSymbolT
 	return Result;
     }
 
-    return Result = KPValue((long) (Left.AsLong() >> Right.AsLong()));
+    return Result.SetLong((Left.AsLong() >> Right.AsLong()));
 } 
 
 
@@ -1557,7 +1557,7 @@ KPValue& KPOperatorGreaterThan::Evaluate(KPValue& Left, KPValue& Right, KPSymbol
 	return Result;
     }
 
-    return Result = KPValue(Left.AsDouble() > Right.AsDouble());
+    return Result.SetBool(Left.AsDouble() > Right.AsDouble());
 } 
 
 
@@ -1584,7 +1584,7 @@ KPValue& KPOperatorLessThan::Evaluate(KPValue& Left, KPValue& Right, KPSymbolTab
 	return Result;
     }
 
-    return Result = KPValue(Left.AsDouble() < Right.AsDouble());
+    return Result.SetBool(Left.AsDouble() < Right.AsDouble());
 } 
 
 
@@ -1611,7 +1611,7 @@ KPValue& KPOperatorGreaterEqual::Evaluate(KPValue& Left, KPValue& Right, KPSymbo
 	return Result;
     }
 
-    return Result = KPValue(Left.AsDouble() >= Right.AsDouble());
+    return Result.SetBool(Left.AsDouble() >= Right.AsDouble());
 } 
 
 
@@ -1638,7 +1638,7 @@ KPValue& KPOperatorLessEqual::Evaluate(KPValue& Left, KPValue& Right, KPSymbolTa
 	return Result;
     }
 
-    return Result = KPValue(Left.AsDouble() <= Right.AsDouble());
+    return Result.SetBool(Left.AsDouble() <= Right.AsDouble());
 } 
 
 
@@ -1746,7 +1746,7 @@ KPValue& KPOperatorBitAnd::Evaluate(KPValue& Left, KPValue& Right, KPSymbolTable
 	return Result;
     }
 
-    return Result = KPValue((long) (Left.AsLong() & Right.AsLong()));
+    return Result.SetLong((Left.AsLong() & Right.AsLong()));
 } 
 
 
@@ -1773,7 +1773,7 @@ KPValue& KPOperatorBitXor::Evaluate(KPValue& Left, KPValue& Right, KPSymbolTable
 	return Result;
     }
 
-    return Result = KPValue((long) (Left.AsLong() ^ Right.AsLong()));
+    return Result.SetLong((Left.AsLong() ^ Right.AsLong()));
 } 
 
 
@@ -1800,7 +1800,7 @@ KPValue& KPOperatorBitOr::Evaluate(KPValue& Left, KPValue& Right, KPSymbolTable*
 	return Result;
     }
 
-    return Result = KPValue((long) (Left.AsLong() | Right.AsLong()));
+    return Result.SetLong((Left.AsLong() | Right.AsLong()));
 } 
 
 
@@ -1869,7 +1869,7 @@ KPValue& KPOperatorAnd::Evaluate(KPValue& Left, KPValue& Right, KPSymbolTable* S
 	return Result;
     }
 
-    return Result = KPValue(Left.AsBool() && Right.AsBool());
+    return Result.SetBool(Left.AsBool() && Right.AsBool());
 } 
 
 
@@ -1896,7 +1896,7 @@ KPValue& KPOperatorOr::Evaluate(KPValue& Left, KPValue& Right, KPSymbolTable* Sy
 	return Result;
     }
 
-    return Result = KPValue(Left.AsBool() || Right.AsBool());
+    return Result.SetBool(Left.AsBool() || Right.AsBool());
 } 
 
 
@@ -2423,7 +2423,7 @@ KPValue& KPOperatorPower::Evaluate(KPValue& Left, KPValue& Right, KPSymbolTable*
 	Result = KPValue(pow(Left.AsComplex(), Power->AsComplex()));
     }
     else {
-	Result = KPValue(pow(Left.AsDouble(), Power->AsDouble()));
+	Result.SetDouble(pow(Left.AsDouble(), Power->AsDouble()));
     }
 
     return Result;
@@ -15,9 +15,12 @@ using namespace kebap;
 
 
 KPNameTable* KPNameTable::fInstance = nullptr;
+static std::mutex gNameTableInstanceMutex;
 
 KPNameTable* KPNameTable::GetInstance()
 {
+    // the name table is shared by all the evaluators, which might be used in parallel threads //
+    std::lock_guard<std::mutex> Lock(gNameTableInstanceMutex);
     if (fInstance == nullptr) {
         fInstance = new KPNameTable();
     }
@@ -36,6 +39,7 @@ KPNameTable::~KPNameTable()
 
 long KPNameTable::NameToId(const string& Name)
 {
+    std::lock_guard<std::mutex> Lock(fMutex);
     if (fIdTable.count(Name) == 0) {
         fIdTable[Name] = fNextId;
 	fNextId++;
@@ -46,6 +50,7 @@ long KPNameTable::NameToId(const string& Name)
 
 string KPNameTable::IdToName(long Id)
 {
+    std::lock_guard<std::mutex> Lock(fMutex);
     map<string, long>::iterator Entry;
     for (
         Entry = fIdTable.begin();
@@ -245,8 +250,6 @@ long KPSymbolTable::RegisterVariable(long VariableId, KPValue* Variable)
     Variable->SetLeftValueFlag();
     Variable->Refer();
 
-    string VariableName = IdToName(VariableId);
-
     pair<long, KPValue*> VariableEntry(VariableId, Variable);
     fVariableEntryList.push_back(VariableEntry);
     fVariableCount++;
@@ -277,6 +280,17 @@ KPValue* KPSymbolTable::GetVariable(long VariableId)
 
     return Variable;
 }
+
+long KPSymbolTable::FindSlot(long VariableId)
+{
+    for (long Slot = (long) fVariableEntryList.size() - 1; Slot >= 0; Slot--) {
+        if (fVariableEntryList[Slot].first == VariableId) {
+            return Slot;
+        }
+    }
+
+    return -1;
+}
     
 long KPSymbolTable::Import(KPSymbolTable* SymbolTable, int Depth)
 {
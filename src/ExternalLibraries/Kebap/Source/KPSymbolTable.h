@@ -7,6 +7,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <mutex>
 #include "KPException.h"
 
 namespace kebap {
@@ -30,6 +31,7 @@ class KPNameTable {
   protected:
     std::map<std::string, long> fIdTable;
     long fNextId;
+    std::mutex fMutex;
 };
 
 
@@ -48,6 +50,15 @@ class KPSymbolTable {
     virtual long RegisterVariable(const std::string& Name, KPValue* Variable);
     virtual long RegisterVariable(long VariableId, KPValue* Variable);
     virtual KPValue* GetVariable(long VariableId);
+    virtual long FindSlot(long VariableId);
+    inline KPValue* GetVariableAt(long Slot, long VariableId) {
+        // a slot stays valid as long as the variable is not removed (i.e., for global variables) //
+        if ((Slot < 0) || (Slot >= (long) fVariableEntryList.size())) {
+            return nullptr;
+        }
+        const std::pair<long, KPValue*>& Entry = fVariableEntryList[Slot];
+        return (Entry.first == VariableId) ? Entry.second : nullptr;
+    }
     virtual void RegisterFunction(long FunctionId, KPFunction* Function);
     virtual KPFunction* GetFunction(long FunctionId);
     virtual long Import(KPSymbolTable* SymbolTable, int Depth = 1);
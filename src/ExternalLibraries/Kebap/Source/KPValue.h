@@ -72,6 +72,12 @@ class KPValue {
     virtual void SetArrayPointerFlag();
     virtual bool IsArrayPointer() const;
     virtual void Dump(std::ostream& os) const;
+  public:
+    // fast path for numeric temporaries (operator and function results): //
+    // equivalent to "*this = KPValue(Value)", without a temporary object  //
+    inline KPValue& SetDouble(double Value);
+    inline KPValue& SetLong(long Value);
+    inline KPValue& SetBool(bool Value);
   protected:
     enum TValueType {
         ValueType_Void, 
@@ -105,6 +111,44 @@ class KPValue {
 
 
 
+inline KPValue& KPValue::SetDouble(double Value)
+{
+    if (fType != ValueType_Double) {
+        return *this = KPValue(Value);
+    }
+    fPrimitiveValue.fDoubleValue = Value;
+    fArrayLength = 0;
+    fIsLeftValue = fIsVariant = fIsArrayPointer = false;
+
+    return *this;
+}
+
+inline KPValue& KPValue::SetLong(long Value)
+{
+    if (fType != ValueType_Long) {
+        return *this = KPValue(Value);
+    }
+    fPrimitiveValue.fLongValue = Value;
+    fArrayLength = 0;
+    fIsLeftValue = fIsVariant = fIsArrayPointer = false;
+
+    return *this;
+}
+
+inline KPValue& KPValue::SetBool(bool Value)
+{
+    if (fType != ValueType_Bool) {
+        return *this = KPValue(Value);
+    }
+    fPrimitiveValue.fBoolValue = Value;
+    fArrayLength = 0;
+    fIsLeftValue = fIsVariant = fIsArrayPointer = false;
+
+    return *this;
+}
+
+
+
 class KPListValue {
   public:
     KPListValue();
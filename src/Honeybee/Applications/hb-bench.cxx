@@ -0,0 +1,330 @@
+// hb-bench.cxx //
+// Author: Sanshiro Enomoto <sanshiro@uw.edu> //
+
+#include <string>
+#include <vector>
+#include <map>
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <chrono>
+#include <functional>
+#include <cstdlib>
+#include <cstdio>
+#include <new>
+#include <unistd.h>
+#include <tabree/KArgumentList.h>
+#include "honeybee.hh"
+#include "compression.hh"
+
+namespace hb = honeybee;
+
+
+// counts heap allocations, to see the memory traffic of each stage //
+static long g_number_of_allocations = 0;
+static long g_allocated_bytes = 0;
+
+void* operator new(size_t a_size)
+{
+    g_number_of_allocations++;
+    g_allocated_bytes += a_size;
+    void* t_pointer = malloc(a_size > 0 ? a_size : 1);
+    if (! t_pointer) {
+        throw std::bad_alloc();
+    }
+    return t_pointer;
+}
+
+void operator delete(void* a_pointer) noexcept
+{
+    free(a_pointer);
+}
+
+void operator delete(void* a_pointer, size_t) noexcept
+{
+    free(a_pointer);
+}
+
+
+
+class stage_timer {
+  public:
+    stage_timer(unsigned a_repeat): f_repeat(a_repeat) {
+        std::cout << std::setw(28) << std::left << "stage" << std::right;
+        std::cout << std::setw(12) << "items" << std::setw(14) << "ns/item";
+        std::cout << std::setw(14) << "bytes/item" << std::setw(14) << "allocs/item" << std::setw(12) << "total ms" << std::endl;
+    }
+    // a_function returns the number of items (data points, names, ...) processed in one call //
+    void measure(const std::string& a_name, std::function<long()> a_function) {
+        long t_items = 0;
+        long t_allocations = g_number_of_allocations, t_bytes = g_allocated_bytes;
+        auto t_start = std::chrono::steady_clock::now();
+        for (unsigned k = 0; k < f_repeat; k++) {
+            t_items += a_function();
+        }
+        auto t_stop = std::chrono::steady_clock::now();
+        t_allocations = g_number_of_allocations - t_allocations;
+        t_bytes = g_allocated_bytes - t_bytes;
+
+        double t_time = std::chrono::duration<double, std::nano>(t_stop - t_start).count();
+        double n = std::max(1L, t_items);
+        std::cout << std::setw(28) << std::left << a_name << std::right;
+        std::cout << std::setw(12) << t_items / f_repeat;
+        std::cout << std::setw(14) << std::fixed << std::setprecision(1) << t_time / n;
+        std::cout << std::setw(14) << std::setprecision(1) << t_bytes / n;
+        std::cout << std::setw(14) << std::setprecision(3) << t_allocations / n;
+        std::cout << std::setw(12) << std::setprecision(1) << t_time / 1e6 << std::endl;
+        std::cout.unsetf(std::ios::floatfield);
+    }
+  protected:
+    unsigned f_repeat;
+};
+
+
+// a site-like config: each module has a raw channel bound to a synthetic channel and calibrated ones //
+static void write_config(const std::string& a_path, unsigned a_number_of_modules)
+{
+    std::ofstream os(a_path);
+    os << "# sensor_table:" << std::endl;
+    os << "#   setup:" << std::endl;
+    os << "#     id: { name: Bench }" << std::endl;
+    for (unsigned i = 0; i < a_number_of_modules; i++) {
+        os << "#     module:" << std::endl;
+        os << "#       id: { name: M" << i << " }" << std::endl;
+        os << "#       channel:" << std::endl;
+        os << "#         id: { name: V }" << std::endl;
+        os << "#         x_synthetic_channel: " << i << std::endl;
+        os << "#       channel:" << std::endl;
+        os << "#         id: { name: degC }" << std::endl;
+        os << "#         default_calibration: V:5.1865e-01+V*(-7.0934e+01+V*(-2.4686e+00+V*(-1.3643e-01)))" << std::endl;
+        os << "#       channel:" << std::endl;
+        os << "#         id: { name: K }" << std::endl;
+        os << "#         default_calibration: degC:degC+273.15" << std::endl;
+    }
+}
+
+
+
+int main(int argc, char** argv)
+{
+    //// Program Arguments ////
+
+    tabree::KArgumentList args(argc, argv);
+    if (! args["--help"].IsVoid()) {
+        std::cerr << "USAGE: " << argv[0] << " [OPTIONS]" << std::endl;
+        std::cerr << "  times each processing stage on synthetic data (no database needed)" << std::endl;
+        std::cerr << "Options:" << std::endl;
+        std::cerr << "  --sensors=N              number of raw sensors (default 100)" << std::endl;
+        std::cerr << "  --length=SEC             length of the time range read (default 3600)" << std::endl;
+        std::cerr << "  --interval=SEC           sampling interval (default 1)" << std::endl;
+        std::cerr << "  --jitter=FRACTION        sampling-time jitter, relative to the interval (default 0.1)" << std::endl;
+        std::cerr << "  --gap-ratio=FRACTION     fraction of time without data (default 0.05)" << std::endl;
+        std::cerr << "  --nan-ratio=FRACTION     fraction of NaN values (default 0.01)" << std::endl;
+        std::cerr << "  --seed=N                 seed of the synthetic data (default 1)" << std::endl;
+        std::cerr << "  --resample=SEC           resampling interval (default 60)" << std::endl;
+        std::cerr << "  --repeat=N               number of repetitions of each stage (default 3)" << std::endl;
+        return -1;
+    }
+
+    unsigned t_number_of_sensors = args["--sensors"].Or(100);
+    double t_length = args["--length"].Or(3600);
+    double t_resampling_interval = args["--resample"].Or(60);
+    unsigned t_repeat = std::max(1, args["--repeat"].Or(3).As<int>());
+
+    hb::synthetic_data_source::parameters t_parameters;
+    t_parameters.f_interval = args["--interval"].Or(1.0);
+    t_parameters.f_jitter = args["--jitter"].Or(0.1);
+    t_parameters.f_gap_ratio = args["--gap-ratio"].Or(0.05);
+    t_parameters.f_nan_ratio = args["--nan-ratio"].Or(0.01);
+    t_parameters.f_seed = args["--seed"].Or(1).As<long>();
+
+    hb::g_log_level = hb::e_log_level_error;
+    const double t_from = 1.6e9, t_to = t_from + t_length;
+    std::cout << "# " << t_number_of_sensors << " sensors, " << t_length << " s at " << t_parameters.f_interval << " s interval";
+    std::cout << ", gaps " << t_parameters.f_gap_ratio << ", NaN " << t_parameters.f_nan_ratio << ", repeat " << t_repeat << std::endl;
+
+    stage_timer t_timer(t_repeat);
+
+
+    //// Config and Sensor Table ////
+
+    std::string t_config_path = "/tmp/hb-bench-" + std::to_string(getpid()) + ".ktf";
+    write_config(t_config_path, t_number_of_sensors);
+
+    hb::sensor_table t_sensor_table;
+    t_timer.measure("config load", [&]() {
+        t_sensor_table = hb::sensor_table();
+        hb::sensor_config_by_file().load(t_sensor_table, t_config_path);
+        return (long) t_sensor_table.find_like({{}}).size();
+    });
+    remove(t_config_path.c_str());
+
+    std::vector<std::string> t_raw_names, t_calibrated_names;
+    for (unsigned i = 0; i < t_number_of_sensors; i++) {
+        t_raw_names.push_back("V.M" + std::to_string(i) + ".Bench");
+        t_calibrated_names.push_back("K.M" + std::to_string(i) + ".Bench");
+    }
+    t_timer.measure("find_like", [&]() {
+        long n = 0;
+        for (const auto& t_name: t_calibrated_names) {
+            n += t_sensor_table.find_like(hb::name_chain::lookup(t_name, ".")).size() > 0;
+        }
+        return n;
+    });
+    t_timer.measure("find_matching (glob)", [&]() {
+        return (long) t_sensor_table.find_matching(hb::sensor_pattern("K.M*1.*")).size();
+    });
+
+    hb::synthetic_data_source t_data_source(t_number_of_sensors, t_parameters);
+    t_data_source.set_number_of_threads(1);
+    t_data_source.bind(t_sensor_table);
+    std::vector<int> t_raw_sensors, t_calibrated_sensors;
+    for (unsigned i = 0; i < t_number_of_sensors; i++) {
+        t_raw_sensors.push_back(t_sensor_table[hb::name_chain(t_raw_names[i], ".")].get_number());
+        t_calibrated_sensors.push_back(t_sensor_table[hb::name_chain(t_calibrated_names[i], ".")].get_number());
+    }
+
+
+    //// Fetch and Calibration ////
+
+    auto count_points = [](const std::vector<hb::series>& a_series_list) {
+        long n = 0;
+        for (const auto& t_series: a_series_list) {
+            n += t_series.size();
+        }
+        return n;
+    };
+
+    std::vector<hb::series> t_raw_series;
+    t_timer.measure("fetch (raw)", [&]() {
+        t_raw_series = t_data_source.read(t_raw_sensors, t_from, t_to);
+        return count_points(t_raw_series);
+    });
+
+    // the calibration chains (V -> degC -> K) applied to copies of the fetched data //
+    std::vector<hb::calibration_index> t_chain; {
+        const hb::sensor& t_degC = t_sensor_table[hb::name_chain("degC.M0.Bench", ".")];
+        const hb::sensor& t_K = t_sensor_table[hb::name_chain("K.M0.Bench", ".")];
+        t_chain.emplace_back(hb::calibration(t_degC, t_sensor_table));
+        t_chain.emplace_back(hb::calibration(t_K, t_sensor_table));
+    }
+    std::vector<hb::series> t_calibrated_series;
+    t_timer.measure("calibration (2 steps)", [&]() {
+        t_calibrated_series = t_raw_series;
+        for (auto& t_series: t_calibrated_series) {
+            for (const auto& t_calib: t_chain) {
+                t_calib.apply(t_series.t(), t_series.x(), 0, t_series.size());
+            }
+        }
+        return count_points(t_calibrated_series);
+    });
+    t_timer.measure("read (fetch+calibration)", [&]() {
+        return count_points(t_data_source.read(t_calibrated_sensors, t_from, t_to));
+    });
+
+
+    //// Resampling ////
+
+    std::vector<std::pair<std::string, hb::resampler::reducer>> t_reducer_list = {
+        {"mean", hb::reduce_to_mean},
+        {"std", hb::reduce_to_std},
+        {"sem", hb::reduce_to_sem},
+        {"min", hb::reduce_to_min},
+        {"max", hb::reduce_to_max},
+        {"median", hb::reduce_to_median},
+        {"count", hb::reduce_to_count},
+        {"sum", hb::reduce_to_sum},
+        {"first", hb::reduce_to_first},
+        {"last", hb::reduce_to_last},
+        {"middle", hb::reduce_to_middle}
+    };
+    for (const auto& t_reducer: t_reducer_list) {
+        t_timer.measure("resample (" + t_reducer.first + ")", [&]() {
+            hb::resampler t_resampler(hb::group_by_time(t_resampling_interval), t_reducer.second);
+            for (const auto& t_series: t_calibrated_series) {
+                t_resampler(t_series);
+            }
+            return count_points(t_calibrated_series);
+        });
+    }
+    t_timer.measure("resample (minmax)", [&]() {
+        hb::resampler t_resampler(hb::group_by_time(t_resampling_interval), hb::reduce_to_envelope);
+        for (const auto& t_series: t_calibrated_series) {
+            t_resampler(t_series);
+        }
+        return count_points(t_calibrated_series);
+    });
+    t_timer.measure("downsample (lttb:1000)", [&]() {
+        for (const auto& t_series: t_calibrated_series) {
+            t_series.apply(hb::downsample_lttb(1000));
+        }
+        return count_points(t_calibrated_series);
+    });
+
+
+    //// Data Frame and Outputs ////
+
+    hb::series_bundle t_series_bundle = hb::zip(std::vector<std::string>(t_calibrated_names), std::vector<hb::series>(t_calibrated_series));
+    hb::data_frame t_data_frame;
+    t_timer.measure("data_frame (aligned)", [&]() {
+        t_data_frame = hb::data_frame(t_series_bundle, hb::resampler(hb::group_to_align(t_series_bundle), hb::reduce_to_middle));
+        return count_points(t_calibrated_series);
+    });
+    t_timer.measure("data_frame (time, mean)", [&]() {
+        t_data_frame = hb::data_frame(t_series_bundle, hb::resampler(hb::group_by_time(t_resampling_interval), hb::reduce_to_mean));
+        return count_points(t_calibrated_series);
+    });
+
+    size_t t_output_size = 0;
+    t_timer.measure("output csv (data_frame)", [&]() {
+        t_output_size += t_data_frame.to_csv().size();
+        return (long) (t_data_frame.number_of_rows() * t_data_frame.number_of_columns());
+    });
+    t_timer.measure("output json (series)", [&]() {
+        for (const auto& t_series: t_calibrated_series) {
+            t_output_size += t_series.to_json("    ").size();
+        }
+        return count_points(t_calibrated_series);
+    });
+    t_timer.measure("output csv (series)", [&]() {
+        for (const auto& t_series: t_calibrated_series) {
+            t_output_size += t_series.to_csv().size();
+        }
+        return count_points(t_calibrated_series);
+    });
+    std::cout << "# " << t_output_size / t_repeat << " bytes output per repetition" << std::endl;
+
+
+    //// Compression ////
+
+    std::vector<hb::compressed_series> t_compressed_list;
+    t_timer.measure("gorilla encode", [&]() {
+        t_compressed_list.clear();
+        for (const auto& t_series: t_calibrated_series) {
+            t_compressed_list.emplace_back(t_series);
+        }
+        return count_points(t_calibrated_series);
+    });
+    t_timer.measure("gorilla decode", [&]() {
+        long n = 0;
+        for (const auto& t_compressed: t_compressed_list) {
+            n += t_compressed.decompress().size();
+        }
+        return n;
+    });
+    t_timer.measure("gorilla decode (10% range)", [&]() {
+        long n = 0;
+        for (const auto& t_compressed: t_compressed_list) {
+            n += t_compressed.decompress(t_from + 0.45 * t_length, t_from + 0.55 * t_length).size();
+        }
+        return n;
+    });
+    size_t t_compressed_size = 0;
+    for (const auto& t_compressed: t_compressed_list) {
+        t_compressed_size += t_compressed.byte_size();
+    }
+    std::cout << "# gorilla: " << std::setprecision(3) << double(t_compressed_size) / std::max(1L, count_points(t_calibrated_series));
+    std::cout << " bytes/point (raw: 16)" << std::endl;
+
+    return 0;
+}
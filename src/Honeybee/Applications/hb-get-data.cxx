@@ -5,8 +5,13 @@
 #include <vector>
 #include <map>
 #include <iostream>
+#include <cmath>
+#include <stdexcept>
+#include <unistd.h>
 #include <tabree/KArgumentList.h>
 #include "honeybee.hh"
+#include "columnar.hh"
+#include "arrow.hh"
 
 namespace hb = honeybee;
 
@@ -20,17 +25,25 @@ int main(int argc, char** argv)
         std::cerr << "USAGE: " << argv[0];
         std::cerr << " SENSOR+ [--from=DATETIME_UTC|--length=SEC] [--to=DATETIME_UTC|--to-ts=UNIXTIME] [OPTIONS]" << std::endl;
         std::cerr << "  SENSOR: sensor name(s), use list-sensors command for defined sensors" << std::endl;
+        std::cerr << "          glob for each name node (ex: degC.RTD*.Acc), or regular expression with re: (ex: re:^degC\\.RTD[0-9]+\\.)" << std::endl;
         std::cerr << "  DATETIME: yyyy-mm-ddThh:mm:ss (ex: 2020-10-28T18:51:32)" << std::endl;
         std::cerr << "Other Options:" << std::endl;
         std::cerr << "  --config=FILE            config file (sensor table etc)" << std::endl;
         std::cerr << "  --dripline-db=DB_URI     dripline database" << std::endl;
+        std::cerr << "  --csv=FILE               CSV file as data source, instead of the database" << std::endl;
+        std::cerr << "  --snapshot=FILE          reuse resolved config/DB metadata (env: HONEYBEE_SNAPSHOT)" << std::endl;
+        std::cerr << "  --metadata-cache=FILE[,TTL] cache DB metadata per DB, TTL in sec (env: HONEYBEE_METADATA_CACHE)" << std::endl;
+        std::cerr << "  --lazy                   bind only the requested sensors (faster on large configs)" << std::endl;
         std::cerr << "  --series                 output time-series of each sensor"<< std::endl;
-        std::cerr << "  --resample=SEC,REDUCER   resampling interval and reducer" << std::endl;
+        std::cerr << "  --resample=SEC,REDUCER   resampling interval (or auto) and reducer" << std::endl;
+        std::cerr << "                           for plots: minmax[:POINTS] (min/max envelope) or lttb[:POINTS] (ex: auto,lttb:2000)" << std::endl;
         std::cerr << "  --summary=REDUCER+       output n,mean,std,sem,min,max,first,last"<< std::endl;
+        std::cerr << "  --format=FORMAT          binary output (to be redirected): arrow (Arrow IPC stream) or hbcol (for mmap readers)"<< std::endl;
         std::cerr << "  --var-KEY=VALUE          set parameter values (used in config files)"<< std::endl;
         std::cerr << "  --delimiter=VALUE        set channel name delimiter"<< std::endl;
         std::cerr << "  --delimiter-input=VALUE  set channel name delimiter in the data store"<< std::endl;
         std::cerr << "  --delimiter-output=VALUE set channel name delimiter for output"<< std::endl;
+        std::cerr << "  --stats=FORMAT           print stage times and counters to stderr (json or prometheus)"<< std::endl;
         std::cerr << "  --verbose                make it verbose"<< std::endl;
         return -1;
     }
@@ -42,6 +55,11 @@ int main(int argc, char** argv)
     
     std::string t_config_file = args["--config"].Or("");
     std::string t_dripline_db = args["--dripline-db"].Or("");
+    std::string t_csv_file = args["--csv"].Or("");
+    std::string t_snapshot = args["--snapshot"].Or("");
+    std::string t_metadata_cache = args["--metadata-cache"].SplitBy(",")[0].Or("");
+    double t_metadata_cache_ttl = args["--metadata-cache"].SplitBy(",")[1].Or(3600);
+    bool t_is_lazy = ! args["--lazy"].IsVoid();
     std::string t_delimiter = args["--delimiter"].Or("");
     std::string t_delimiter_input = args["--delimiter-input"].Or(t_delimiter);
     std::string t_delimiter_output = args["--delimiter-output"].Or(t_delimiter.substr(0,1));
@@ -61,8 +79,47 @@ int main(int argc, char** argv)
     bool t_output_series = ! args["--series"].IsVoid();
     
     double t_resampling_enabled = ! args["--resample"].IsVoid();
-    double t_resampling_interval = args["--resample"].SplitBy(",")[0].Or(0); // 0 for auto
+    std::string t_resampling_interval_text = args["--resample"].SplitBy(",")[0].Or("auto");
+    double t_resampling_interval = (t_resampling_interval_text.empty() || (t_resampling_interval_text == "auto")) ? 0 : std::stod(t_resampling_interval_text); // 0 for auto
     std::string t_resampling_reducer = args["--resample"].SplitBy(",")[1].Or("last");
+    // plot-oriented downsampling, to a number of points independent of the data rate //
+    hb::downsampling_spec t_downsampling;
+    try {
+        t_downsampling = hb::downsampling_spec(t_resampling_reducer);
+    }
+    catch (std::invalid_argument &e) {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return -1;
+    }
+    const std::string& t_downsampler = t_downsampling.get_method();
+
+    // the groups, aligned to the end, are made on multiples of the interval (as the DB rollup buckets) //
+    if ((t_resampling_interval >= 1) && (std::fmod(t_resampling_interval, 1) == 0)) {
+        long t_step = t_resampling_interval;
+        long t_end = long(hb::datetime(t_to));
+        t_to = hb::datetime(((t_end + t_step - 1) / t_step) * t_step).as_string();
+    }
+    
+    std::string t_stats_format = args["--stats"].Or("");
+    if (! args["--stats"].IsVoid() && t_stats_format.empty()) {
+        t_stats_format = "json";
+    }
+    if (! t_stats_format.empty() && (t_stats_format != "json") && (t_stats_format != "prometheus")) {
+        std::cerr << "ERROR: unknown stats format: " << t_stats_format << std::endl;
+        return -1;
+    }
+    
+    std::string t_output_format = args["--format"].Or(args["--output"].Or(""));  // --output: old name
+    if (! t_output_format.empty() && (t_output_format != "hbcol") && (t_output_format != "arrow")) {
+        std::cerr << "ERROR: unknown output format: " << t_output_format << std::endl;
+        return -1;
+    }
+    bool t_output_hbcol = (t_output_format == "hbcol");
+    bool t_output_arrow = (t_output_format == "arrow");
+    if ((t_output_hbcol || t_output_arrow) && isatty(STDOUT_FILENO)) {
+        std::cerr << "ERROR: binary output to a terminal; redirect it to a file" << std::endl;
+        return -1;
+    }
     
     bool t_output_summary = ! args["--summary"].IsVoid();
     std::vector<std::string> t_summary_items; {
@@ -92,11 +149,31 @@ int main(int argc, char** argv)
     hb::honeybee_app t_honeybee_app;
     t_honeybee_app.add_config_file(t_config_file);
     t_honeybee_app.add_dripline_db(t_dripline_db);
+    t_honeybee_app.add_csv_file(t_csv_file);
+    if (! t_snapshot.empty()) {
+        t_honeybee_app.set_snapshot_file(t_snapshot);
+    }
+    if (! t_metadata_cache.empty()) {
+        t_honeybee_app.set_metadata_cache(t_metadata_cache, t_metadata_cache_ttl);
+    }
+    t_honeybee_app.set_lazy(t_is_lazy);
     t_honeybee_app.set_delimiter(t_delimiter_input, t_delimiter_output);
     for (auto& variable: t_variables) {
         t_honeybee_app.add_variable(variable.first, variable.second);
     }
     
+    // every stage from here to the outputs is recorded //
+    hb::pipeline_metrics t_metrics;
+    hb::metrics_scope t_metrics_scope(t_metrics);
+    auto t_report_stats = [&]() {
+        if (t_stats_format == "json") {
+            std::cerr << t_metrics.to_json() << std::endl;
+        }
+        else if (t_stats_format == "prometheus") {
+            std::cerr << t_metrics.to_prometheus();
+        }
+    };
+    
     auto t_series_bundle = t_honeybee_app.read(
         t_sensor_names, hb::datetime(t_from), hb::datetime(t_to),
         t_resampling_interval, t_resampling_reducer
@@ -120,6 +197,7 @@ int main(int argc, char** argv)
 
     // output summary (reduced values) //
     if (t_output_summary) {
+        hb::metrics_span t_span(hb::pipeline_metrics::e_stage_serialize);
         std::string row_delim = "", col_delim="";
         std::cout << "{"; 
         for (auto t_iter: t_series_bundle.items()) {
@@ -140,24 +218,49 @@ int main(int argc, char** argv)
             std::cout << " }";
         }
         std::cout << std::endl << "}" << std::endl;
-
+        
+        t_span.stop();
+        t_report_stats();
         return 0;
     }
 
             
     //// Resampling (if necessary) ////
 
-    if (! t_output_series && t_series_bundle.size() > 1) {
+    // LTTB picks points at the data times, which differ between the series; these are output as series //
+    if (t_resampling_enabled && (t_downsampler == "lttb")) {
+        if (! t_output_series && ! t_output_hbcol && ! t_output_arrow && (t_series_bundle.size() > 1)) {
+            std::cerr << "ERROR: lttb makes unaligned series; use --series or --format for more than one sensor" << std::endl;
+            return -1;
+        }
+        hb::metrics_span t_span(hb::pipeline_metrics::e_stage_resample);
+        unsigned t_number_of_points = t_downsampling.get_lttb_points(long(hb::datetime(t_from)), long(hb::datetime(t_to)), t_resampling_interval);
+        for (auto& t_series: t_series_bundle.values()) {
+            t_series = t_series.apply(hb::downsample_lttb(t_number_of_points));
+        }
+        t_resampling_enabled = false;
+    }
+    
+    // binary formats hold unaligned series as they are //
+    if (! t_output_series && ! t_output_hbcol && ! t_output_arrow && t_series_bundle.size() > 1) {
         t_resampling_enabled = true;
     }
     
     hb::data_frame t_data_frame;
     if (t_resampling_enabled) {
+        hb::metrics_span t_span(hb::pipeline_metrics::e_stage_resample);
         auto reducer = t_reducer_list[t_resampling_reducer];
         if (! reducer) {
             reducer = hb::reduce_to_middle;
         }
-        if (t_resampling_interval > 0) {
+        if (t_downsampler == "minmax") {
+            double t_step = t_downsampling.get_minmax_step(long(hb::datetime(t_from)), long(hb::datetime(t_to)), t_resampling_interval);
+            t_data_frame = hb::data_frame(
+                t_series_bundle,
+                hb::resampler(hb::group_by_time(t_step), hb::reduce_to_envelope)
+            );
+        }
+        else if (t_resampling_interval > 0) {
             t_data_frame = hb::data_frame(
                 t_series_bundle,
                 hb::resampler(hb::group_by_time(t_resampling_interval), reducer)
@@ -174,8 +277,33 @@ int main(int argc, char** argv)
     
     //// Outputs ////
 
+    hb::metrics_span t_serialize_span(hb::pipeline_metrics::e_stage_serialize);
+    
+    // output binary columnar file //
+    if (t_output_hbcol) {
+        hb::columnar_writer t_writer;
+        if (t_resampling_enabled) {
+            t_writer.add(t_data_frame);
+        }
+        else {
+            t_writer.add(t_series_bundle);
+        }
+        t_writer.write(std::cout);
+    }
+    
+    // output Arrow IPC stream (long table of the series, or the data frame) //
+    else if (t_output_arrow) {
+        hb::arrow_stream_writer t_writer(std::cout);
+        if (t_resampling_enabled) {
+            t_writer.write(t_data_frame);
+        }
+        else {
+            t_writer.write(t_series_bundle);
+        }
+    }
+    
     // output series in JSON //
-    if (t_output_series) {
+    else if (t_output_series) {
         std::string row_delim = "";
         std::cout << "{"; 
         for (unsigned i: honeybee::arange(t_series_bundle)) {
@@ -201,6 +329,9 @@ int main(int argc, char** argv)
     else if (t_series_bundle.size() == 1) {
         std::cout << t_series_bundle[0].to_csv(t_series_bundle.keys()[0]);
     }
+    std::cout << std::flush;
     
+    t_serialize_span.stop();
+    t_report_stats();
     return 0;
 }
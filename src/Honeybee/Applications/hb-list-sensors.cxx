@@ -19,9 +19,13 @@ int main(int argc, char** argv)
         std::cerr << "USAGE: " << argv[0];
         std::cerr << " SENSOR+ [OPTIONS]" << std::endl;
         std::cerr << "  SENSOR: sensor name(s), use list-sensors command for defined sensors" << std::endl;
+        std::cerr << "          glob for each name node (ex: degC.RTD*.Acc), or regular expression with re: (ex: re:^degC\\.RTD[0-9]+\\.)" << std::endl;
         std::cerr << "Options:" << std::endl;
         std::cerr << "  --config=FILE            config file (sensor table etc)" << std::endl;
         std::cerr << "  --dripline-db=DB_URI     dripline database" << std::endl;
+        std::cerr << "  --csv=FILE               CSV file as data source, instead of the database" << std::endl;
+        std::cerr << "  --snapshot=FILE          reuse resolved config/DB metadata (env: HONEYBEE_SNAPSHOT)" << std::endl;
+        std::cerr << "  --metadata-cache=FILE[,TTL] cache DB metadata per DB, TTL in sec (env: HONEYBEE_METADATA_CACHE)" << std::endl;
         std::cerr << "  --fields                 list of sensor data fields to display"<< std::endl;
         std::cerr << "  --var-KEY=VALUE          set parameter values (used in config files)"<< std::endl;
         std::cerr << "  --delimiter=VALUE        set channel name delimiter"<< std::endl;
@@ -42,6 +46,10 @@ int main(int argc, char** argv)
     
     std::string t_config_file = args["--config"].Or("");
     std::string t_dripline_db = args["--dripline-db"].Or("");
+    std::string t_csv_file = args["--csv"].Or("");
+    std::string t_snapshot = args["--snapshot"].Or("");
+    std::string t_metadata_cache = args["--metadata-cache"].SplitBy(",")[0].Or("");
+    double t_metadata_cache_ttl = args["--metadata-cache"].SplitBy(",")[1].Or(3600);
     std::string t_delimiter = args["--delimiter"].Or("");
     std::string t_delimiter_input = args["--delimiter-input"].Or(t_delimiter);
     std::string t_delimiter_output = args["--delimiter-output"].Or(t_delimiter.substr(0,1));
@@ -75,6 +83,13 @@ int main(int argc, char** argv)
     hb::honeybee_app t_honeybee_app;
     t_honeybee_app.add_config_file(t_config_file);
     t_honeybee_app.add_dripline_db(t_dripline_db);
+    t_honeybee_app.add_csv_file(t_csv_file);
+    if (! t_snapshot.empty()) {
+        t_honeybee_app.set_snapshot_file(t_snapshot);
+    }
+    if (! t_metadata_cache.empty()) {
+        t_honeybee_app.set_metadata_cache(t_metadata_cache, t_metadata_cache_ttl);
+    }
     t_honeybee_app.set_delimiter(t_delimiter_input, t_delimiter_output);
     for (auto& variable: t_variables) {
         t_honeybee_app.add_variable(variable.first, variable.second);
@@ -87,7 +102,20 @@ int main(int argc, char** argv)
     
     std::set<int> t_sensors;
     for (auto& t_name: t_sensor_names) {
-        for (auto& t_number: t_sensor_table->find_like(hb::name_chain(t_name, "./-_"))) {
+        std::vector<int> t_matches;
+        if (hb::sensor_pattern::is_pattern(t_name)) {
+            try {
+                t_matches = t_sensor_table->find_matching(hb::sensor_pattern(t_name, "./-_", t_delimiter_output));
+            }
+            catch (std::regex_error &e) {
+                std::cerr << "ERROR: bad sensor pattern: " << t_name << ": " << e.what() << std::endl;
+                return -1;
+            }
+        }
+        else {
+            t_matches = t_sensor_table->find_like(hb::name_chain::lookup(t_name, "./-_"));
+        }
+        for (auto& t_number: t_matches) {
             t_sensors.insert(t_number);
         }
     }
@@ -0,0 +1,93 @@
+// hb-rollup.cxx //
+// Author: Sanshiro Enomoto <sanshiro@uw.edu> //
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <iostream>
+#include <algorithm>
+#include <exception>
+#include <tabree/KArgumentList.h>
+#include "utils.hh"
+#include "pgsql.hh"
+#include "rollup.hh"
+
+namespace hb = honeybee;
+
+
+int main(int argc, char** argv)
+{
+    //// Program Arguments ////
+    
+    tabree::KArgumentList args(argc, argv);
+    if (args["--dripline-db"].IsVoid() || ! args["--help"].IsVoid()) {
+        std::cerr << "USAGE: " << argv[0] << " --dripline-db=DB_URI [OPTIONS]" << std::endl;
+        std::cerr << "  Creates and updates the rollup tables (hb_rollup, hb_rollup_state) in the Dripline database;" << std::endl;
+        std::cerr << "  resampled reads with mean, min, max, first or last use them. Run it periodically, e.g. by cron." << std::endl;
+        std::cerr << "  DATETIME: yyyy-mm-ddThh:mm:ss (ex: 2020-10-28T18:51:32)" << std::endl;
+        std::cerr << "Options:" << std::endl;
+        std::cerr << "  --resolutions=SEC,...    bucket sizes, each in whole seconds (default: 60,3600,86400)" << std::endl;
+        std::cerr << "  --from=DATETIME_UTC      rebuild from this time, e.g. after late inserts (default: continue)" << std::endl;
+        std::cerr << "  --to=DATETIME_UTC        roll up the buckets completed before this time (default: now)" << std::endl;
+        std::cerr << "  --status                 show the rolled-up ranges and do nothing else" << std::endl;
+        std::cerr << "  --drop                   delete the rollup tables and do nothing else" << std::endl;
+        std::cerr << "  --verbose                make it verbose"<< std::endl;
+        return -1;
+    }
+
+    std::string t_dripline_db = args["--dripline-db"].As<std::string>();
+    std::vector<unsigned> t_resolutions;
+    for (const auto& t_item: args["--resolutions"].Or("60,3600,86400").SplitBy(",")) {
+        long t_resolution = t_item.second.Or(0);
+        if (t_resolution <= 0) {
+            std::cerr << "ERROR: bad resolution: " << t_item.second.As<std::string>() << std::endl;
+            return -1;
+        }
+        t_resolutions.push_back(t_resolution);
+    }
+    // finer ones first, to be used as the input of the coarser ones //
+    std::sort(t_resolutions.begin(), t_resolutions.end());
+    
+    double t_from = args["--from"].IsVoid() ? -1 : double(long(hb::datetime(args["--from"].As<std::string>())));
+    double t_to = args["--to"].IsVoid() ? -1 : double(long(hb::datetime(args["--to"].As<std::string>())));
+    
+    if (! args["--verbose"].IsVoid()) {
+        hb::g_log_level = hb::e_log_level_info;
+    }
+
+    
+    //// Rollup ////
+    
+    try {
+        hb::dripline_rollup t_rollup(std::make_shared<hb::pgsql>(t_dripline_db));
+        if (! args["--drop"].IsVoid()) {
+            t_rollup.drop();
+            std::cerr << "rollup tables deleted" << std::endl;
+            return 0;
+        }
+        if (! args["--status"].IsVoid()) {
+            if (! t_rollup.is_available()) {
+                std::cerr << "no rollup tables" << std::endl;
+                return 0;
+            }
+            for (const auto& t_coverage: t_rollup.get_status()) {
+                std::cout << t_coverage.f_resolution << "s: ";
+                std::cout << hb::datetime(long(t_coverage.f_since)).as_string() << " - " << hb::datetime(long(t_coverage.f_until)).as_string();
+                std::cout << ", " << t_coverage.f_number_of_buckets << " buckets" << std::endl;
+            }
+            return 0;
+        }
+        
+        t_rollup.create();
+        for (unsigned t_resolution: t_resolutions) {
+            long n = t_rollup.update(t_resolution, t_from, t_to);
+            std::cerr << t_resolution << "s: " << n << " buckets written" << std::endl;
+        }
+    }
+    catch (std::exception &e) {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return -1;
+    }
+    
+    return 0;
+}
@@ -0,0 +1,726 @@
+// hb-server.cxx //
+// Author: Sanshiro Enomoto <sanshiro@uw.edu> //
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <deque>
+#include <iostream>
+#include <sstream>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <limits>
+#include <cmath>
+#include <stdexcept>
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+#include <csignal>
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <tabree/KArgumentList.h>
+#include <tabree/KTree.h>
+#include <tabree/KJsonTreeFormat.h>
+#include "honeybee.hh"
+
+namespace hb = honeybee;
+
+
+// Requests are JSON objects with the same keys as the hb-get-data / hb-list-sensors options:
+//   POST /get-data      {"sensors": ["SENSOR", ...], "length": 3600, "resample": "60,mean", ...}
+//   POST /list-sensors  {"sensors": ["PATTERN", ...], "fields": "name,options"}
+//   POST /reload
+//   GET  /metrics       stage times and counters of the /get-data requests, in the Prometheus text format
+// For GET, the options are taken from the query string instead (ex: /get-data?sensors=A,B&length=60).
+// Responses have the same contents as the command outputs.
+
+namespace {
+    struct http_request {
+        std::string f_method, f_path;
+        tabree::KTree f_options;
+    };
+
+    struct http_response {
+        int f_status = 200;
+        std::string f_content_type = "application/json";
+        std::string f_body;
+    };
+
+
+    std::string url_decode(const std::string& a_text)
+    {
+        std::string t_text;
+        for (unsigned i = 0; i < a_text.size(); i++) {
+            if ((a_text[i] == '%') && (i+2 < a_text.size())) {
+                t_text += char(std::stoi(a_text.substr(i+1, 2), nullptr, 16));
+                i += 2;
+            }
+            else {
+                t_text += (a_text[i] == '+') ? ' ' : a_text[i];
+            }
+        }
+        return t_text;
+    }
+
+    std::string json_escape(const std::string& a_text)
+    {
+        std::string t_text;
+        for (unsigned char c: a_text) {
+            if ((c == '"') || (c == '\\')) {
+                t_text += '\\';
+                t_text += c;
+            }
+            else if (c == '\n') {
+                t_text += "\\n";
+            }
+            else if (c < 0x20) {
+                char t_code[8];
+                snprintf(t_code, sizeof(t_code), "\\u%04x", c);
+                t_text += t_code;
+            }
+            else {
+                t_text += c;
+            }
+        }
+        return t_text;
+    }
+
+    std::string error_body(const std::string& a_message)
+    {
+        return "{ \"error\": \"" + json_escape(a_message) + "\" }\n";
+    }
+
+    // requests are small JSON objects; larger ones are refused before reading //
+    const size_t g_max_body_size = 1 << 20;
+
+    // reads one request; false on a broken connection //
+    bool read_request(int a_fd, http_request& a_request)
+    {
+        std::string t_buffer;
+        size_t t_header_end;
+        char t_chunk[4096];
+        while ((t_header_end = t_buffer.find("\r\n\r\n")) == std::string::npos) {
+            ssize_t n = ::read(a_fd, t_chunk, sizeof(t_chunk));
+            if ((n <= 0) || (t_buffer.size() > (1 << 16))) {
+                return false;
+            }
+            t_buffer.append(t_chunk, n);
+        }
+
+        std::istringstream t_header(t_buffer.substr(0, t_header_end));
+        std::string t_target, t_line;
+        t_header >> a_request.f_method >> t_target;
+        std::getline(t_header, t_line);
+        size_t t_content_length = 0;
+        while (std::getline(t_header, t_line)) {
+            auto t_colon = t_line.find(':');
+            if (t_colon == std::string::npos) {
+                continue;
+            }
+            std::string t_key = t_line.substr(0, t_colon);
+            for (auto& c: t_key) {
+                c = tolower(c);
+            }
+            if (t_key == "content-length") {
+                t_content_length = std::stoul(t_line.substr(t_colon+1));
+                if (t_content_length > g_max_body_size) {
+                    throw std::runtime_error("request body too large");
+                }
+            }
+        }
+
+        std::string t_body = t_buffer.substr(t_header_end + 4);
+        while (t_body.size() < t_content_length) {
+            ssize_t n = ::read(a_fd, t_chunk, std::min(sizeof(t_chunk), t_content_length - t_body.size()));
+            if (n <= 0) {
+                return false;
+            }
+            t_body.append(t_chunk, n);
+        }
+
+        auto t_question = t_target.find('?');
+        a_request.f_path = t_target.substr(0, t_question);
+        if (t_question != std::string::npos) {
+            std::istringstream t_query(t_target.substr(t_question+1));
+            std::string t_item;
+            while (std::getline(t_query, t_item, '&')) {
+                auto t_equal = t_item.find('=');
+                std::string t_key = url_decode(t_item.substr(0, t_equal));
+                a_request.f_options[t_key] = (t_equal == std::string::npos) ? std::string("true") : url_decode(t_item.substr(t_equal+1));
+            }
+        }
+        if (t_body.find_first_not_of(" \t\r\n") != std::string::npos) {
+            std::istringstream t_input(t_body);
+            tabree::KJsonTreeFormat().Read(a_request.f_options, t_input);
+        }
+
+        return true;
+    }
+
+    void write_response(int a_fd, const http_response& a_response)
+    {
+        static const std::map<int, std::string> t_reasons = {
+            {200, "OK"}, {400, "Bad Request"}, {404, "Not Found"}, {500, "Internal Server Error"}
+        };
+        std::ostringstream os;
+        os << "HTTP/1.1 " << a_response.f_status << " " << t_reasons.at(a_response.f_status) << "\r\n";
+        os << "Content-Type: " << a_response.f_content_type << "\r\n";
+        os << "Content-Length: " << a_response.f_body.size() << "\r\n";
+        os << "Connection: close\r\n\r\n";
+        std::string t_message = os.str() + a_response.f_body;
+        for (size_t t_written = 0; t_written < t_message.size(); ) {
+            ssize_t n = ::write(a_fd, t_message.data() + t_written, t_message.size() - t_written);
+            if (n <= 0) {
+                break;
+            }
+            t_written += n;
+        }
+    }
+
+
+    // list of values, given as a JSON array or a comma-separated string //
+    std::vector<std::string> get_list(const tabree::KTree& a_options, const std::string& a_key)
+    {
+        std::vector<std::string> t_list;
+        const tabree::KTree& t_node = a_options[a_key];
+        if (t_node.IsArray()) {
+            for (unsigned i = 0; i < t_node.Length(); i++) {
+                t_list.push_back(t_node[i].As<std::string>());
+            }
+        }
+        else if (! t_node.IsVoid()) {
+            for (auto t_item: t_node.Value().SplitBy(",")) {
+                t_list.push_back(t_item.second);
+            }
+        }
+        return t_list;
+    }
+
+    bool is_set(const tabree::KTree& a_options, const std::string& a_key)
+    {
+        if (a_options[a_key].IsVoid()) {
+            return false;
+        }
+        std::string t_value = a_options[a_key].As<std::string>();
+        return (t_value != "false") && (t_value != "0");
+    }
+}
+
+
+
+class hb_server {
+  public:
+    hb_server(hb::honeybee_app& a_app): f_app(a_app) {}
+    void serve(int a_listen_fd, unsigned a_number_of_workers);
+  protected:
+    void work();
+    http_response handle(const http_request& a_request);
+    http_response get_data(const tabree::KTree& a_options);
+    http_response list_sensors(const tabree::KTree& a_options);
+  protected:
+    hb::honeybee_app& f_app;
+    std::deque<int> f_queue;
+    std::mutex f_queue_mutex;
+    std::condition_variable f_queue_filled;
+  protected:
+    hb::pipeline_metrics f_metrics;  // accumulated over the /get-data requests
+    std::mutex f_metrics_mutex;
+};
+
+
+void hb_server::serve(int a_listen_fd, unsigned a_number_of_workers)
+{
+    std::vector<std::thread> t_workers;
+    for (unsigned i = 0; i < a_number_of_workers; i++) {
+        t_workers.emplace_back(&hb_server::work, this);
+    }
+
+    while (true) {
+        int t_fd = accept(a_listen_fd, nullptr, nullptr);
+        if (t_fd < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cerr << "ERROR: accept: " << strerror(errno) << std::endl;
+            break;
+        }
+        // not to let a stalled client occupy a worker //
+        struct timeval t_timeout = { 30, 0 };
+        setsockopt(t_fd, SOL_SOCKET, SO_RCVTIMEO, &t_timeout, sizeof(t_timeout));
+        {
+            std::lock_guard<std::mutex> t_lock(f_queue_mutex);
+            f_queue.push_back(t_fd);
+        }
+        f_queue_filled.notify_one();
+    }
+
+    {
+        std::lock_guard<std::mutex> t_lock(f_queue_mutex);
+        f_queue.push_back(-1);  // stop marker, passed over to the next worker
+    }
+    f_queue_filled.notify_all();
+    for (auto& t_worker: t_workers) {
+        t_worker.join();
+    }
+}
+
+void hb_server::work()
+{
+    while (true) {
+        int t_fd; {
+            std::unique_lock<std::mutex> t_lock(f_queue_mutex);
+            f_queue_filled.wait(t_lock, [&]{ return ! f_queue.empty(); });
+            t_fd = f_queue.front();
+            if (t_fd < 0) {
+                return;
+            }
+            f_queue.pop_front();
+        }
+
+        http_request t_request;
+        http_response t_response;
+        try {
+            if (! read_request(t_fd, t_request)) {
+                close(t_fd);
+                continue;
+            }
+        }
+        catch (std::exception &e) {
+            t_request.f_path = "";
+            t_response.f_status = 400;
+            t_response.f_body = error_body(std::string("bad request: ") + e.what());
+        }
+        if (t_response.f_status == 200) {
+            try {
+                t_response = handle(t_request);
+            }
+            catch (std::exception &e) {
+                t_response.f_status = 500;
+                t_response.f_content_type = "application/json";
+                t_response.f_body = error_body(e.what());
+            }
+        }
+        write_response(t_fd, t_response);
+        close(t_fd);
+        if (hb::g_log_level >= hb::e_log_level_info) {
+            std::cerr << t_request.f_method << " " << t_request.f_path << ": " << t_response.f_status << std::endl;
+        }
+    }
+}
+
+http_response hb_server::handle(const http_request& a_request)
+{
+    if (a_request.f_path == "/get-data") {
+        hb::pipeline_metrics t_metrics;
+        http_response t_response; {
+            hb::metrics_scope t_scope(t_metrics);
+            t_response = get_data(a_request.f_options);
+        }
+        std::lock_guard<std::mutex> t_lock(f_metrics_mutex);
+        f_metrics += t_metrics;
+        return t_response;
+    }
+    if (a_request.f_path == "/metrics") {
+        http_response t_response;
+        t_response.f_content_type = "text/plain; version=0.0.4";
+        std::lock_guard<std::mutex> t_lock(f_metrics_mutex);
+        t_response.f_body = f_metrics.to_prometheus();
+        return t_response;
+    }
+    if (a_request.f_path == "/list-sensors") {
+        return list_sensors(a_request.f_options);
+    }
+    if (a_request.f_path == "/reload") {
+        http_response t_response;
+        bool t_is_reloaded = f_app.reload();
+        t_response.f_status = t_is_reloaded ? 200 : 500;
+        t_response.f_body = std::string("{ \"reloaded\": ") + (t_is_reloaded ? "true" : "false") + " }\n";
+        return t_response;
+    }
+
+    http_response t_response;
+    t_response.f_status = 404;
+    t_response.f_body = error_body("unknown request: " + a_request.f_path);
+    return t_response;
+}
+
+http_response hb_server::get_data(const tabree::KTree& a_options)
+{
+    http_response t_response;
+    std::ostringstream os;
+
+    //// Request Parameters (as hb-get-data) ////
+
+    std::vector<std::string> t_sensor_names = get_list(a_options, "sensors");
+    if (t_sensor_names.empty()) {
+        t_response.f_status = 400;
+        t_response.f_body = "{ \"error\": \"no sensors specified\" }\n";
+        return t_response;
+    }
+
+    double t_to_ts = a_options["to-ts"].Or(long(hb::datetime::now()));
+    std::string t_to = a_options["to"].Or(hb::datetime(t_to_ts).as_string());
+    double length = a_options["length"].Or(60);
+    std::string t_from_ts = a_options["from-ts"].Or(long(hb::datetime(t_to)-length));
+    std::string t_from = a_options["from"].Or(hb::datetime(t_from_ts).as_string());
+    if (
+        (a_options["to-ts"].IsVoid() && a_options["to"].IsVoid()) &&
+        (! a_options["from-ts"].IsVoid() || ! a_options["from"].IsVoid())
+    ){
+        t_to = hb::datetime((hb::datetime(t_from)+length)).as_string();
+    }
+
+    bool t_output_series = is_set(a_options, "series");
+
+    bool t_resampling_enabled = ! a_options["resample"].IsVoid();
+    std::string t_resampling_interval_text = a_options["resample"].Value().SplitBy(",")[0].Or("auto");
+    double t_resampling_interval = (t_resampling_interval_text.empty() || (t_resampling_interval_text == "auto")) ? 0 : std::stod(t_resampling_interval_text); // 0 for auto
+    std::string t_resampling_reducer = a_options["resample"].Value().SplitBy(",")[1].Or("last");
+    // plot-oriented downsampling, to a number of points independent of the data rate //
+    hb::downsampling_spec t_downsampling;
+    try {
+        t_downsampling = hb::downsampling_spec(t_resampling_reducer);
+    }
+    catch (std::invalid_argument &e) {
+        t_response.f_status = 400;
+        t_response.f_body = error_body(e.what());
+        return t_response;
+    }
+    const std::string& t_downsampler = t_downsampling.get_method();
+
+    // the groups, aligned to the end, are made on multiples of the interval (as the DB rollup buckets) //
+    if ((t_resampling_interval >= 1) && (std::fmod(t_resampling_interval, 1) == 0)) {
+        long t_step = t_resampling_interval;
+        long t_end = long(hb::datetime(t_to));
+        t_to = hb::datetime(((t_end + t_step - 1) / t_step) * t_step).as_string();
+    }
+
+    bool t_output_summary = ! a_options["summary"].IsVoid();
+    std::vector<std::string> t_summary_items = get_list(a_options, "summary");
+    if (t_output_summary && (t_summary_items.empty() || (t_summary_items.front() == "true") || (t_summary_items.front() == "1"))) {
+        t_summary_items = {{"n", "mean", "std"}};
+    }
+
+
+    //// Fetch ////
+
+    auto t_series_bundle = f_app.read(
+        t_sensor_names, hb::datetime(t_from), hb::datetime(t_to),
+        t_resampling_interval, t_resampling_reducer
+    );
+
+
+    //// Reducing (if necessary)  ////
+
+    std::map<std::string, std::function<double(const hb::series&)>> t_reducer_list = {
+        {"mean", hb::reduce_to_mean},
+        {"std", hb::reduce_to_std},
+        {"sem", hb::reduce_to_sem},
+        {"min", hb::reduce_to_min},
+        {"max", hb::reduce_to_max},
+        {"median", hb::reduce_to_mean},
+        {"count", hb::reduce_to_count},
+        {"sum", hb::reduce_to_sum},
+        {"first", hb::reduce_to_first},
+        {"last", hb::reduce_to_last},
+        {"middle", hb::reduce_to_middle}
+    };
+
+    if (t_output_summary) {
+        hb::metrics_span t_span(hb::pipeline_metrics::e_stage_serialize);
+        std::string row_delim = "", col_delim="";
+        os << "{";
+        for (auto t_iter: t_series_bundle.items()) {
+            os << row_delim << std::endl; row_delim = ","; col_delim=" ";
+            os << "    \"" << t_iter.first << "\": ";
+            os << "{";
+            for (const std::string& t_item_name: t_summary_items) {
+                os << col_delim; col_delim=", ";
+                os << "\"" << t_item_name << "\": ";
+                auto t_reducer = t_reducer_list[t_item_name];
+                double x = t_reducer ? t_iter.second.reduce(t_reducer) : std::numeric_limits<double>::quiet_NaN();
+                if (std::isnan(x)) {
+                    os << "null";
+                }
+                else {
+                    os << x;
+                }
+            }
+            os << " }";
+        }
+        os << std::endl << "}" << std::endl;
+        t_response.f_body = os.str();
+
+        return t_response;
+    }
+
+
+    //// Resampling (if necessary) ////
+
+    // LTTB picks points at the data times, which differ between the series; these are output as series //
+    if (t_resampling_enabled && (t_downsampler == "lttb")) {
+        if (! t_output_series && (t_series_bundle.size() > 1)) {
+            t_response.f_status = 400;
+            t_response.f_body = "{ \"error\": \"lttb makes unaligned series; use series for more than one sensor\" }\n";
+            return t_response;
+        }
+        hb::metrics_span t_span(hb::pipeline_metrics::e_stage_resample);
+        unsigned t_number_of_points = t_downsampling.get_lttb_points(long(hb::datetime(t_from)), long(hb::datetime(t_to)), t_resampling_interval);
+        for (auto& t_series: t_series_bundle.values()) {
+            t_series = t_series.apply(hb::downsample_lttb(t_number_of_points));
+        }
+        t_resampling_enabled = false;
+    }
+    
+    if (! t_output_series && t_series_bundle.size() > 1) {
+        t_resampling_enabled = true;
+    }
+
+    hb::data_frame t_data_frame;
+    if (t_resampling_enabled) {
+        hb::metrics_span t_span(hb::pipeline_metrics::e_stage_resample);
+        auto reducer = t_reducer_list[t_resampling_reducer];
+        if (! reducer) {
+            reducer = hb::reduce_to_middle;
+        }
+        if (t_downsampler == "minmax") {
+            double t_step = t_downsampling.get_minmax_step(long(hb::datetime(t_from)), long(hb::datetime(t_to)), t_resampling_interval);
+            t_data_frame = hb::data_frame(
+                t_series_bundle,
+                hb::resampler(hb::group_by_time(t_step), hb::reduce_to_envelope)
+            );
+        }
+        else if (t_resampling_interval > 0) {
+            t_data_frame = hb::data_frame(
+                t_series_bundle,
+                hb::resampler(hb::group_by_time(t_resampling_interval), reducer)
+            );
+        }
+        else {
+            t_data_frame = hb::data_frame(
+                t_series_bundle,
+                hb::resampler(hb::group_to_align(t_series_bundle), reducer)
+            );
+        }
+    }
+
+
+    //// Outputs ////
+
+    hb::metrics_span t_serialize_span(hb::pipeline_metrics::e_stage_serialize);
+    if (t_output_series) {
+        std::string row_delim = "";
+        os << "{";
+        for (unsigned i: honeybee::arange(t_series_bundle)) {
+            os << row_delim << std::endl; row_delim = ",";
+            os << "    \"" << t_series_bundle.keys()[i] << "\": ";
+            if (! t_resampling_enabled) {
+                os << t_series_bundle[i].to_json("    ");
+            }
+            else {
+                os << t_data_frame.columns()[i].to_json("    ");
+            }
+        }
+        os << std::endl << "}" << std::endl;
+    }
+    else if (t_resampling_enabled) {
+        t_response.f_content_type = "text/csv";
+        os << t_data_frame.to_csv();
+    }
+    else if (t_series_bundle.size() == 1) {
+        t_response.f_content_type = "text/csv";
+        os << t_series_bundle[0].to_csv(t_series_bundle.keys()[0]);
+    }
+    t_response.f_body = os.str();
+
+    return t_response;
+}
+
+http_response hb_server::list_sensors(const tabree::KTree& a_options)
+{
+    http_response t_response;
+
+    std::vector<std::string> t_sensor_names = get_list(a_options, "sensors");
+    if (t_sensor_names.empty()) {
+        t_sensor_names.push_back("");
+    }
+    std::vector<std::string> t_fields; {
+        if (a_options["fields"].Or("").As<std::string>() != "ALL") {
+            t_fields = get_list(a_options, "fields");
+            if (t_fields.empty()) {
+                t_fields = {{"number", "name", "default_calibration", "options"}};
+            }
+        }
+    }
+
+    // the table is held while listing, even if a reload replaces it meanwhile //
+    auto t_sensor_table = f_app.get_sensor_table();
+    std::string t_delimiter_output = f_app.get_output_delimiter();
+
+    std::set<int> t_sensors;
+    for (auto& t_name: t_sensor_names) {
+        std::vector<int> t_matches;
+        if (hb::sensor_pattern::is_pattern(t_name)) {
+            t_matches = t_sensor_table->find_matching(hb::sensor_pattern(t_name, "./-_", t_delimiter_output));
+        }
+        else {
+            t_matches = t_sensor_table->find_like(hb::name_chain::lookup(t_name, "./-_"));
+        }
+        for (auto& t_number: t_matches) {
+            t_sensors.insert(t_number);
+        }
+    }
+
+    std::ostringstream os;
+    std::string delimiter = "";
+    os << "[";
+    for (auto& t_number: t_sensors) {
+        os << delimiter << std::endl;
+        os << "    " << (*t_sensor_table)[t_number].to_json(t_fields, t_delimiter_output);
+        delimiter = ",";
+    }
+    os << std::endl << "]" << std::endl;
+    t_response.f_body = os.str();
+
+    return t_response;
+}
+
+
+
+int main(int argc, char** argv)
+{
+    //// Program Arguments ////
+
+    tabree::KArgumentList args(argc, argv);
+    if (! args["--help"].IsVoid()) {
+        std::cerr << "USAGE: " << argv[0] << " [OPTIONS]" << std::endl;
+        std::cerr << "  serves get-data and list-sensors requests over HTTP, keeping the config and DB connections" << std::endl;
+        std::cerr << "  (ex: curl -d '{\"sensors\": [\"degC.*\"], \"length\": 600, \"summary\": \"n,mean\"}' localhost:8080/get-data)" << std::endl;
+        std::cerr << "Options:" << std::endl;
+        std::cerr << "  --port=PORT              TCP port on localhost (default 8080)" << std::endl;
+        std::cerr << "  --host=ADDRESS           address to listen on (default 127.0.0.1)" << std::endl;
+        std::cerr << "  --socket=PATH            listen on a UNIX-domain socket instead of TCP" << std::endl;
+        std::cerr << "  --threads=N              number of requests handled concurrently (default 8)" << std::endl;
+        std::cerr << "  --auto-reload            reload the config when it changes" << std::endl;
+        std::cerr << "  --config=FILE            config file (sensor table etc)" << std::endl;
+        std::cerr << "  --dripline-db=DB_URI     dripline database" << std::endl;
+        std::cerr << "  --csv=FILE               CSV file as data source, instead of the database" << std::endl;
+        std::cerr << "  --snapshot=FILE          reuse resolved config/DB metadata (env: HONEYBEE_SNAPSHOT)" << std::endl;
+        std::cerr << "  --metadata-cache=FILE[,TTL] cache DB metadata per DB, TTL in sec (env: HONEYBEE_METADATA_CACHE)" << std::endl;
+        std::cerr << "  --var-KEY=VALUE          set parameter values (used in config files)"<< std::endl;
+        std::cerr << "  --delimiter=VALUE        set channel name delimiter"<< std::endl;
+        std::cerr << "  --delimiter-input=VALUE  set channel name delimiter in the data store"<< std::endl;
+        std::cerr << "  --delimiter-output=VALUE set channel name delimiter for output"<< std::endl;
+        std::cerr << "  --verbose                make it verbose (log requests)"<< std::endl;
+        return -1;
+    }
+
+    std::string t_config_file = args["--config"].Or("");
+    std::string t_dripline_db = args["--dripline-db"].Or("");
+    std::string t_csv_file = args["--csv"].Or("");
+    std::string t_snapshot = args["--snapshot"].Or("");
+    std::string t_metadata_cache = args["--metadata-cache"].SplitBy(",")[0].Or("");
+    double t_metadata_cache_ttl = args["--metadata-cache"].SplitBy(",")[1].Or(3600);
+    std::string t_delimiter = args["--delimiter"].Or("");
+    std::string t_delimiter_input = args["--delimiter-input"].Or(t_delimiter);
+    std::string t_delimiter_output = args["--delimiter-output"].Or(t_delimiter.substr(0,1));
+
+    int t_port = args["--port"].Or(8080);
+    std::string t_host = args["--host"].Or("127.0.0.1");
+    std::string t_socket_path = args["--socket"].Or("");
+    unsigned t_number_of_threads = args["--threads"].Or(8);
+
+    std::vector<std::pair<std::string, std::string>> t_variables; {
+        for (auto param: args.OptionTable()) {
+            if (param.first.substr(0, 6) == "--var-") {
+                t_variables.emplace_back(param.first.substr(6), param.second);
+            }
+        }
+    }
+
+    if (! args["--verbose"].IsVoid()) {
+        hb::g_log_level = hb::e_log_level_info;
+    }
+
+
+    //// Construction ////
+
+    hb::honeybee_app t_honeybee_app;
+    t_honeybee_app.add_config_file(t_config_file);
+    t_honeybee_app.add_dripline_db(t_dripline_db);
+    t_honeybee_app.add_csv_file(t_csv_file);
+    if (! t_snapshot.empty()) {
+        t_honeybee_app.set_snapshot_file(t_snapshot);
+    }
+    if (! t_metadata_cache.empty()) {
+        t_honeybee_app.set_metadata_cache(t_metadata_cache, t_metadata_cache_ttl);
+    }
+    t_honeybee_app.set_delimiter(t_delimiter_input, t_delimiter_output);
+    for (auto& variable: t_variables) {
+        t_honeybee_app.add_variable(variable.first, variable.second);
+    }
+    t_honeybee_app.set_max_db_connections(t_number_of_threads);
+
+    // the config and the DB metadata are loaded here, not at the first request //
+    try {
+        t_honeybee_app.get_sensor_table();
+    }
+    catch (std::exception &e) {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return -1;
+    }
+    if (! args["--auto-reload"].IsVoid()) {
+        t_honeybee_app.enable_auto_reload();
+    }
+
+
+    //// Listening ////
+
+    signal(SIGPIPE, SIG_IGN);
+    int t_listen_fd;
+    if (! t_socket_path.empty()) {
+        t_listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        struct sockaddr_un t_address;
+        memset(&t_address, 0, sizeof(t_address));
+        t_address.sun_family = AF_UNIX;
+        strncpy(t_address.sun_path, t_socket_path.c_str(), sizeof(t_address.sun_path)-1);
+        unlink(t_socket_path.c_str());
+        if ((t_listen_fd < 0) || (bind(t_listen_fd, (struct sockaddr*) &t_address, sizeof(t_address)) < 0)) {
+            std::cerr << "ERROR: unable to bind socket: " << t_socket_path << ": " << strerror(errno) << std::endl;
+            return -1;
+        }
+    }
+    else {
+        t_listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+        int t_yes = 1;
+        setsockopt(t_listen_fd, SOL_SOCKET, SO_REUSEADDR, &t_yes, sizeof(t_yes));
+        struct sockaddr_in t_address;
+        memset(&t_address, 0, sizeof(t_address));
+        t_address.sin_family = AF_INET;
+        t_address.sin_port = htons(t_port);
+        if (
+            (t_listen_fd < 0) || (inet_pton(AF_INET, t_host.c_str(), &t_address.sin_addr) != 1) ||
+            (bind(t_listen_fd, (struct sockaddr*) &t_address, sizeof(t_address)) < 0)
+        ){
+            std::cerr << "ERROR: unable to bind: " << t_host << ":" << t_port << ": " << strerror(errno) << std::endl;
+            return -1;
+        }
+    }
+    if (listen(t_listen_fd, 64) < 0) {
+        std::cerr << "ERROR: listen: " << strerror(errno) << std::endl;
+        return -1;
+    }
+    std::cerr << "hb-server: listening on " << (t_socket_path.empty() ? (t_host + ":" + std::to_string(t_port)) : t_socket_path) << std::endl;
+
+    hb_server(t_honeybee_app).serve(t_listen_fd, t_number_of_threads);
+    close(t_listen_fd);
+
+    return 0;
+}
@@ -0,0 +1,429 @@
+/*
+ * arrow.cc
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sanshiro Enomoto <sanshiro@uw.edu>
+ */
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <stdexcept>
+#include "arrow.hh"
+
+using namespace std;
+using namespace honeybee;
+
+
+namespace {
+    // Minimal FlatBuffers serializer for the Arrow message headers (Message.fbs, Schema.fbs).
+    // Objects are laid out front to back, so that all the offsets point forward as required.
+    struct fb_object;
+    using fb_pointer = shared_ptr<fb_object>;
+
+    struct fb_object {
+        enum kind_t { e_table, e_string, e_bytes, e_vector };
+        struct field {
+            unsigned f_slot;
+            string f_value;      // inline scalar, or empty for a child object
+            fb_pointer f_child;
+        };
+        kind_t f_kind;
+        vector<field> f_fields;      // table
+        string f_data;               // string, or elements of a scalar/struct vector
+        unsigned f_count = 0, f_alignment = 1;
+        vector<fb_pointer> f_items;  // vector of tables
+
+        fb_object(kind_t a_kind): f_kind(a_kind) {}
+        template<typename T> fb_object& add(unsigned a_slot, T a_value) {
+            f_fields.push_back({a_slot, string((const char*) &a_value, sizeof(a_value)), nullptr});
+            return *this;
+        }
+        fb_object& add(unsigned a_slot, fb_pointer a_child) {
+            f_fields.push_back({a_slot, "", a_child});
+            return *this;
+        }
+    };
+
+    fb_pointer fb_table()
+    {
+        return make_shared<fb_object>(fb_object::e_table);
+    }
+
+    fb_pointer fb_string(const string& a_value)
+    {
+        auto t_object = make_shared<fb_object>(fb_object::e_string);
+        t_object->f_data = a_value;
+        return t_object;
+    }
+
+    template<typename T> fb_pointer fb_struct_vector(const vector<T>& a_items)
+    {
+        auto t_object = make_shared<fb_object>(fb_object::e_bytes);
+        t_object->f_data.assign((const char*) a_items.data(), a_items.size() * sizeof(T));
+        t_object->f_count = a_items.size();
+        t_object->f_alignment = 8;
+        return t_object;
+    }
+
+    fb_pointer fb_table_vector(const vector<fb_pointer>& a_items)
+    {
+        auto t_object = make_shared<fb_object>(fb_object::e_vector);
+        t_object->f_items = a_items;
+        return t_object;
+    }
+
+
+    class fb_serializer {
+      public:
+        string serialize(const fb_pointer& a_root) {
+            f_buffer.assign(4, '\0');
+            patch(0, write(*a_root));
+            f_buffer.resize((f_buffer.size() + 7) / 8 * 8, '\0');
+            return std::move(f_buffer);
+        }
+      protected:
+        // pads so that (position + a_prefix) is aligned //
+        size_t pad(size_t a_alignment, size_t a_prefix=0) {
+            size_t t_position = (f_buffer.size() + a_prefix + a_alignment - 1) / a_alignment * a_alignment - a_prefix;
+            f_buffer.resize(t_position, '\0');
+            return t_position;
+        }
+        template<typename T> void put(T a_value) {
+            f_buffer.append((const char*) &a_value, sizeof(a_value));
+        }
+        // uoffset at a_position to a_target (forward) //
+        void patch(size_t a_position, size_t a_target) {
+            uint32_t t_offset = a_target - a_position;
+            memcpy(&f_buffer[a_position], &t_offset, sizeof(t_offset));
+        }
+        size_t write(const fb_object& a_object) {
+            if (a_object.f_kind == fb_object::e_string) {
+                size_t t_position = pad(4);
+                put<uint32_t>(a_object.f_data.size());
+                f_buffer.append(a_object.f_data);
+                f_buffer.push_back('\0');
+                return t_position;
+            }
+            if (a_object.f_kind == fb_object::e_bytes) {
+                size_t t_position = pad(std::max(4u, a_object.f_alignment), 4);
+                put<uint32_t>(a_object.f_count);
+                f_buffer.append(a_object.f_data);
+                return t_position;
+            }
+            if (a_object.f_kind == fb_object::e_vector) {
+                size_t t_position = pad(4);
+                put<uint32_t>(a_object.f_items.size());
+                f_buffer.append(4 * a_object.f_items.size(), '\0');
+                for (unsigned i = 0; i < a_object.f_items.size(); i++) {
+                    patch(t_position + 4 + 4 * i, write(*a_object.f_items[i]));
+                }
+                return t_position;
+            }
+            return write_table(a_object);
+        }
+        size_t write_table(const fb_object& a_table) {
+            // inline fields, larger ones first to avoid padding; child objects by 4-byte offsets //
+            vector<const fb_object::field*> t_fields;
+            unsigned t_number_of_slots = 0;
+            for (const auto& t_field: a_table.f_fields) {
+                t_fields.push_back(&t_field);
+                t_number_of_slots = std::max(t_number_of_slots, t_field.f_slot + 1);
+            }
+            auto size_of = [](const fb_object::field* a_field) {
+                return a_field->f_child ? 4 : a_field->f_value.size();
+            };
+            std::stable_sort(t_fields.begin(), t_fields.end(), [&](const fb_object::field* a, const fb_object::field* b) {
+                return size_of(a) > size_of(b);
+            });
+            vector<uint16_t> t_slot_offsets(t_number_of_slots, 0);
+            size_t t_table_size = 4;  // soffset to the vtable
+            for (const auto* t_field: t_fields) {
+                size_t t_size = size_of(t_field);
+                t_table_size = (t_table_size + t_size - 1) / t_size * t_size;
+                t_slot_offsets[t_field->f_slot] = t_table_size;
+                t_table_size += t_size;
+            }
+
+            // the vtable immediately precedes the table, which is aligned for 8-byte scalars //
+            size_t t_vtable_size = 4 + 2 * t_number_of_slots;
+            size_t t_vtable_position = pad(8, t_vtable_size);
+            size_t t_table_position = t_vtable_position + t_vtable_size;
+            put<uint16_t>(t_vtable_size);
+            put<uint16_t>(t_table_size);
+            for (uint16_t t_offset: t_slot_offsets) {
+                put<uint16_t>(t_offset);
+            }
+            f_buffer.resize(t_table_position + t_table_size, '\0');
+            int32_t t_soffset = t_table_position - t_vtable_position;
+            memcpy(&f_buffer[t_table_position], &t_soffset, sizeof(t_soffset));
+            for (const auto* t_field: t_fields) {
+                if (! t_field->f_child) {
+                    memcpy(&f_buffer[t_table_position + t_slot_offsets[t_field->f_slot]], t_field->f_value.data(), t_field->f_value.size());
+                }
+            }
+            for (const auto* t_field: t_fields) {
+                if (t_field->f_child) {
+                    size_t t_position = t_table_position + t_slot_offsets[t_field->f_slot];
+                    patch(t_position, write(*t_field->f_child));
+                }
+            }
+
+            return t_table_position;
+        }
+      protected:
+        string f_buffer;
+    };
+
+
+    //// Arrow Metadata ////
+
+    enum {
+        e_metadata_version_v5 = 4,
+        e_header_schema = 1, e_header_dictionary_batch = 2, e_header_record_batch = 3,
+        e_type_int = 2, e_type_floating_point = 3, e_type_utf8 = 5, e_type_timestamp = 10,
+        e_precision_double = 2, e_time_unit_microsecond = 2
+    };
+
+    struct column_type {
+        uint8_t f_type_id;
+        fb_pointer f_type;
+    };
+
+    column_type make_double_type()
+    {
+        auto t_type = fb_table();
+        t_type->add<int16_t>(0, e_precision_double);
+        return { e_type_floating_point, t_type };
+    }
+
+    column_type make_timestamp_type()
+    {
+        auto t_type = fb_table();
+        t_type->add<int16_t>(0, e_time_unit_microsecond);
+        t_type->add(1, fb_string("UTC"));
+        return { e_type_timestamp, t_type };
+    }
+
+    column_type make_utf8_type()
+    {
+        return { e_type_utf8, fb_table() };
+    }
+
+    fb_pointer make_int32_type()
+    {
+        auto t_type = fb_table();
+        t_type->add<int32_t>(0, 32);
+        t_type->add<uint8_t>(1, true);
+        return t_type;
+    }
+
+    fb_pointer make_field(const string& a_name, const column_type& a_type, int64_t a_dictionary_id=-1)
+    {
+        auto t_field = fb_table();
+        t_field->add(0, fb_string(a_name));
+        t_field->add<uint8_t>(1, false);  // NaN's are values, not nulls
+        t_field->add<uint8_t>(2, a_type.f_type_id);
+        t_field->add(3, a_type.f_type);
+        if (a_dictionary_id >= 0) {
+            auto t_encoding = fb_table();
+            t_encoding->add<int64_t>(0, a_dictionary_id);
+            t_encoding->add(1, make_int32_type());
+            t_field->add(4, t_encoding);
+        }
+        t_field->add(5, fb_table_vector({}));  // children, required by readers
+        return t_field;
+    }
+
+    fb_pointer make_message(uint8_t a_header_type, fb_pointer a_header, int64_t a_body_length)
+    {
+        auto t_message = fb_table();
+        t_message->add<int16_t>(0, e_metadata_version_v5);
+        t_message->add<uint8_t>(1, a_header_type);
+        t_message->add(2, a_header);
+        t_message->add<int64_t>(3, a_body_length);
+        return t_message;
+    }
+
+    string make_schema_message(const vector<fb_pointer>& a_fields)
+    {
+        auto t_schema = fb_table();
+        t_schema->add<int16_t>(0, 0);  // little endian
+        t_schema->add(1, fb_table_vector(a_fields));
+        return fb_serializer().serialize(make_message(e_header_schema, t_schema, 0));
+    }
+
+    size_t padded(size_t a_size)
+    {
+        return (a_size + 7) / 8 * 8;
+    }
+
+    struct buffer_entry {
+        int64_t f_offset, f_length;
+    };
+
+    template<typename T> fb_pointer make_record_batch(int64_t a_length, const vector<T>& a_nodes, const vector<buffer_entry>& a_buffer_layout)
+    {
+        auto t_batch = fb_table();
+        t_batch->add<int64_t>(0, a_length);
+        t_batch->add(1, fb_struct_vector(a_nodes));
+        t_batch->add(2, fb_struct_vector(a_buffer_layout));
+        return t_batch;
+    }
+
+    // positions of the body buffers, each padded to 8 bytes //
+    template<typename T> vector<buffer_entry> make_buffer_layout(const vector<T>& a_buffers, int64_t& a_body_length)
+    {
+        vector<buffer_entry> t_layout;
+        a_body_length = 0;
+        for (const auto& t_buffer: a_buffers) {
+            t_layout.push_back({a_body_length, (int64_t) t_buffer.f_size});
+            a_body_length += padded(t_buffer.f_size);
+        }
+        return t_layout;
+    }
+
+    bool is_little_endian()
+    {
+        uint16_t t_value = 1;
+        return *(const char*) &t_value == 1;
+    }
+
+    vector<int64_t> to_microseconds(const vector<double>& a_t)
+    {
+        vector<int64_t> t_us(a_t.size());
+        for (size_t k = 0; k < a_t.size(); k++) {
+            t_us[k] = std::isfinite(a_t[k]) ? std::llround(a_t[k] * 1e6) : 0;
+        }
+        return t_us;
+    }
+}
+
+
+
+void arrow_stream_writer::write_message(const string& a_metadata, const vector<buffer>& a_body)
+{
+    // encapsulated message: continuation marker, metadata size, metadata (8-byte padded), body //
+    int32_t t_prefix[2] = { -1, (int32_t) a_metadata.size() };
+    f_output.write((const char*) t_prefix, sizeof(t_prefix));
+    f_output.write(a_metadata.data(), a_metadata.size());
+
+    static const char t_zeros[8] = { 0 };
+    for (const auto& t_buffer: a_body) {
+        f_output.write((const char*) t_buffer.f_data, t_buffer.f_size);
+        f_output.write(t_zeros, padded(t_buffer.f_size) - t_buffer.f_size);
+    }
+}
+
+void arrow_stream_writer::write_end_of_stream()
+{
+    int32_t t_marker[2] = { -1, 0 };
+    f_output.write((const char*) t_marker, sizeof(t_marker));
+    f_output.flush();
+    if (! f_output) {
+        throw std::runtime_error("arrow: write error");
+    }
+}
+
+void arrow_stream_writer::write(const data_frame& a_data_frame)
+{
+    if (! is_little_endian()) {
+        throw std::runtime_error("arrow: big-endian hosts are not supported");
+    }
+    static const vector<double> t_empty;
+    const vector<double>& t = a_data_frame.number_of_columns() > 0 ? a_data_frame.t() : t_empty;
+    int64_t n = t.size();
+
+    vector<fb_pointer> t_fields;
+    t_fields.push_back(make_field("DateTime", make_timestamp_type()));
+    t_fields.push_back(make_field("TimeStamp", make_double_type()));
+    for (const auto& t_name: a_data_frame.column_names()) {
+        t_fields.push_back(make_field(t_name, make_double_type()));
+    }
+    write_message(make_schema_message(t_fields), {});
+
+    // each field has an empty validity bitmap (no nulls) and a value buffer //
+    vector<int64_t> t_datetime = to_microseconds(t);
+    vector<field_node> t_nodes;
+    vector<buffer> t_body;
+    t_nodes.push_back({n, 0});
+    t_body.push_back({nullptr, 0});
+    t_body.push_back({t_datetime.data(), t_datetime.size() * sizeof(int64_t)});
+    t_nodes.push_back({n, 0});
+    t_body.push_back({nullptr, 0});
+    t_body.push_back({t.data(), t.size() * sizeof(double)});
+    for (const auto& t_column: a_data_frame.columns()) {
+        t_nodes.push_back({n, 0});
+        t_body.push_back({nullptr, 0});
+        t_body.push_back({t_column.x().data(), t_column.x().size() * sizeof(double)});
+    }
+
+    int64_t t_body_length;
+    vector<buffer_entry> t_layout = make_buffer_layout(t_body, t_body_length);
+    auto t_batch = make_record_batch(n, t_nodes, t_layout);
+    write_message(fb_serializer().serialize(make_message(e_header_record_batch, t_batch, t_body_length)), t_body);
+
+    write_end_of_stream();
+}
+
+void arrow_stream_writer::write(const series_bundle& a_series_bundle)
+{
+    if (! is_little_endian()) {
+        throw std::runtime_error("arrow: big-endian hosts are not supported");
+    }
+    const int64_t t_dictionary_id = 0;
+
+    vector<fb_pointer> t_fields;
+    t_fields.push_back(make_field("sensor", make_utf8_type(), t_dictionary_id));
+    t_fields.push_back(make_field("DateTime", make_timestamp_type()));
+    t_fields.push_back(make_field("TimeStamp", make_double_type()));
+    t_fields.push_back(make_field("Value", make_double_type()));
+    write_message(make_schema_message(t_fields), {});
+
+    // sensor names, referred to by index from the batches //
+    {
+        const vector<string>& t_names = a_series_bundle.keys();
+        vector<int32_t> t_offsets = { 0 };
+        string t_data;
+        for (const auto& t_name: t_names) {
+            t_data += t_name;
+            t_offsets.push_back(t_data.size());
+        }
+        vector<field_node> t_nodes = { { (int64_t) t_names.size(), 0 } };
+        vector<buffer> t_body = {
+            { nullptr, 0 },
+            { t_offsets.data(), t_offsets.size() * sizeof(int32_t) },
+            { t_data.data(), t_data.size() }
+        };
+        int64_t t_body_length;
+        vector<buffer_entry> t_layout = make_buffer_layout(t_body, t_body_length);
+        auto t_dictionary_batch = fb_table();
+        t_dictionary_batch->add<int64_t>(0, t_dictionary_id);
+        t_dictionary_batch->add(1, make_record_batch(t_names.size(), t_nodes, t_layout));
+        write_message(fb_serializer().serialize(make_message(e_header_dictionary_batch, t_dictionary_batch, t_body_length)), t_body);
+    }
+
+    for (unsigned i = 0; i < a_series_bundle.size(); i++) {
+        const series& t_series = a_series_bundle[i];
+        int64_t n = t_series.size();
+        vector<int32_t> t_sensor(n, i);
+        vector<int64_t> t_datetime = to_microseconds(t_series.t());
+        vector<field_node> t_nodes(4, {n, 0});
+        vector<buffer> t_body = {
+            { nullptr, 0 }, { t_sensor.data(), t_sensor.size() * sizeof(int32_t) },
+            { nullptr, 0 }, { t_datetime.data(), t_datetime.size() * sizeof(int64_t) },
+            { nullptr, 0 }, { t_series.t().data(), t_series.t().size() * sizeof(double) },
+            { nullptr, 0 }, { t_series.x().data(), t_series.x().size() * sizeof(double) }
+        };
+        int64_t t_body_length;
+        vector<buffer_entry> t_layout = make_buffer_layout(t_body, t_body_length);
+        auto t_batch = make_record_batch(n, t_nodes, t_layout);
+        write_message(fb_serializer().serialize(make_message(e_header_record_batch, t_batch, t_body_length)), t_body);
+    }
+
+    write_end_of_stream();
+}
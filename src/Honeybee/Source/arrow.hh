@@ -0,0 +1,45 @@
+/*
+ * arrow.hh
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sanshiro Enomoto <sanshiro@uw.edu>
+ */
+
+#ifndef HONEYBEE_ARROW_HH_
+#define HONEYBEE_ARROW_HH_ 1
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <cstdint>
+#include "series.hh"
+
+
+namespace honeybee {
+    using namespace std;
+
+    // Apache Arrow IPC streaming format, written from the column buffers without the Arrow library.
+    // Each write() makes a complete stream (schema, batches and end-of-stream marker):
+    //   data frame:     one batch of DateTime (timestamp[us, UTC]), TimeStamp (double) and the columns (double)
+    //   series bundle:  long table of sensor (dictionary of names), DateTime, TimeStamp and Value, one batch per series
+    // Read in Python by: pyarrow.ipc.open_stream(sys.stdin.buffer).read_all()
+    class arrow_stream_writer {
+      public:
+        arrow_stream_writer(ostream& a_output): f_output(a_output) {}
+        void write(const data_frame& a_data_frame);
+        void write(const series_bundle& a_series_bundle);
+      protected:
+        struct buffer {
+            const void* f_data;
+            size_t f_size;
+        };
+        struct field_node {
+            int64_t f_length, f_null_count;
+        };
+        void write_message(const string& a_metadata, const vector<buffer>& a_body);
+        void write_end_of_stream();
+        ostream& f_output;
+    };
+
+}
+#endif
@@ -8,6 +8,9 @@
 #include <string>
 #include <memory>
 #include <regex>
+#include <cmath>
+#include <stdexcept>
+#include <algorithm>
 #include "sensor_table.hh"
 #include "evaluator.hh"
 #include "calibration.hh"
@@ -38,8 +41,10 @@ calibration::calibration(const sensor& a_sensor, const sensor_table& a_sensor_ta
 
     f_description = strip(a_sensor.get_calibration());
     f_is_identity = false;
+    f_linearity = 0;
     f_input = sensor{}.get_number();
     f_evaluator = 0;
+    f_cache_mode = e_cache_none;
     if (f_description.empty()) {
         return;
     }
@@ -58,7 +63,7 @@ calibration::calibration(const sensor& a_sensor, const sensor_table& a_sensor_ta
     }
     else {
         for (unsigned i = 0; i < t_variable_name_chain.size(); i++) {
-            t_input_name_chain[i] = t_variable_name_chain[i];
+            t_input_name_chain.set(i, t_variable_name_chain[i]);
         }
     }
     auto t_candidates = a_sensor_table.find_like(t_input_name_chain);
@@ -79,6 +84,7 @@ calibration::calibration(const sensor& a_sensor, const sensor_table& a_sensor_ta
     
     if ((f_variable_name == t_exp_text) || t_exp_text.empty()) {
         f_is_identity = true;
+        f_linearity = +1;
         return;
     }
 
@@ -93,5 +99,202 @@ calibration::calibration(const sensor& a_sensor, const sensor_table& a_sensor_ta
     catch (std::exception &e) {
         cerr << "ERROR: bad calibration expression: " << e.what() << endl;
         f_evaluator = 0;
+        return;
+    }
+    f_linearity = find_linearity();
+
+    setup_cache(strip(a_sensor.get_calibration_cache()));
+}
+
+int calibration::find_linearity() const
+{
+    // values at a few probe points, which tell the usual polynomials and functions from a line //
+    static const double t_probes[] = { -1e6, -1e3, -10, -1, -0.5, 0.5, 2, 3, 10, 1e3, 1e6 };
+    double a, b;
+    try {
+        b = (*f_evaluator)(0);
+        a = (*f_evaluator)(1) - b;
+        if (! std::isfinite(a) || ! std::isfinite(b)) {
+            return 0;
+        }
+        for (double x: t_probes) {
+            double y = (*f_evaluator)(x);
+            if (! (fabs(y - (a*x + b)) <= 1e-9 * (fabs(a*x) + fabs(b)))) {
+                return 0;
+            }
+        }
+    }
+    catch (std::exception &e) {
+        return 0;
+    }
+    
+    return (a >= 0) ? +1 : -1;
+}
+
+calibration calibration::clone() const
+{
+    calibration t_calibration(*this);
+    if (f_evaluator) {
+        t_calibration.f_evaluator.reset(f_evaluator->Clone());
+    }
+    if (f_memo) {
+        // not copied: the original may be being filled by another thread //
+        t_calibration.f_memo = make_shared<unordered_map<double, double>>();
+    }
+    
+    return t_calibration;
+}
+
+void calibration::setup_cache(const string& a_cache_description)
+{
+    if (a_cache_description.empty() || (a_cache_description == "none")) {
+        return;
+    }
+
+    vector<string> t_params = name_chain(a_cache_description, ",").get_chain();
+    if (t_params[0] == "memo") {
+        if (t_params.size() > 1) {
+            try {
+                if (t_params.size() > 2) {
+                    throw std::invalid_argument("memo,LIMIT expected");
+                }
+                long t_limit = stol(t_params[1]);
+                if (t_limit < 0) {
+                    throw std::invalid_argument("negative limit");
+                }
+                f_memo_limit = t_limit;
+            }
+            catch (std::exception &e) {
+                cerr << "ERROR: bad calibration cache parameter: " << a_cache_description << ": " << e.what() << endl;
+                return;
+            }
+        }
+        f_memo = make_shared<unordered_map<double, double>>();
+        f_cache_mode = e_cache_memo;
+        return;
+    }
+    if (t_params[0] != "lut") {
+        cerr << "ERROR: unknown calibration cache type: " << a_cache_description << endl;
+        return;
+    }
+
+    double t_min, t_max, t_step;
+    try {
+        if (t_params.size() != 4) {
+            throw std::invalid_argument("lut,MIN,MAX,STEP expected");
+        }
+        t_min = stod(t_params[1]);
+        t_max = stod(t_params[2]);
+        t_step = stod(t_params[3]);
+        if (! (t_step > 0) || ! (t_max > t_min)) {
+            throw std::invalid_argument("empty range");
+        }
+    }
+    catch (std::exception &e) {
+        cerr << "ERROR: bad calibration cache parameter: " << a_cache_description << ": " << e.what() << endl;
+        return;
+    }
+    
+    static const double t_max_lut_size = 1 << 24;
+    double t_size = floor((t_max - t_min) / t_step + 1e-9) + 1;
+    if (t_size > t_max_lut_size) {
+        cerr << "ERROR: calibration lookup table too large: " << a_cache_description << endl;
+        return;
+    }
+    
+    auto t_lut = make_shared<vector<double>>();
+    t_lut->reserve(size_t(t_size));
+    try {
+        for (unsigned k = 0; k < unsigned(t_size); k++) {
+            t_lut->push_back((*f_evaluator)(t_min + k * t_step));
+        }
+    }
+    catch (std::exception &e) {
+        cerr << "ERROR: unable to build calibration lookup table: " << e.what() << endl;
+        return;
+    }
+    if (t_lut->size() < 2) {
+        return;
+    }
+    
+    f_lut = t_lut;
+    f_lut_min = t_min;
+    f_lut_step = t_step;
+    f_cache_mode = e_cache_lut;
+}
+
+
+
+bool calibration_index::add(double a_start, double a_stop, const calibration& a_calibration)
+{
+    version t_version = { a_start, a_stop, a_calibration };
+    auto iter = std::upper_bound(
+        f_versions.begin(), f_versions.end(), a_start,
+        [](double t, const version& v) { return t < v.f_start; }
+    );
+    // apply() picks one version per time; overlaps must be resolved before (see attach_versions()) //
+    if ((iter != f_versions.begin()) && (a_start < (iter-1)->f_stop)) {
+        return false;
+    }
+    if ((iter != f_versions.end()) && (iter->f_start < a_stop)) {
+        return false;
+    }
+    f_versions.insert(iter, t_version);
+    
+    return true;
+}
+
+calibration_index calibration_index::clone() const
+{
+    calibration_index t_index(f_default.clone());
+    for (const auto& t_version: f_versions) {
+        t_index.f_versions.push_back({ t_version.f_start, t_version.f_stop, t_version.f_calibration.clone() });
+    }
+    
+    return t_index;
+}
+
+string calibration_index::get_description() const
+{
+    string t_description = f_default.get_description();
+    for (const auto& t_version: f_versions) {
+        t_description += " | [" + to_string(long(t_version.f_start)) + "," + to_string(long(t_version.f_stop)) + "): ";
+        t_description += t_version.f_calibration.get_description();
+    }
+    
+    return t_description;
+}
+
+void calibration_index::apply(const vector<double>& t, vector<double>& x, size_t a_begin, size_t a_end) const
+{
+    if (f_versions.empty() || (t.size() != x.size())) {
+        for (size_t k = a_begin; k < a_end; k++) {
+            x[k] = f_default(x[k]);
+        }
+        return;
+    }
+
+    // single walk over the (time-ordered) series and the sorted versions //
+    auto find_version = [&](double tk) -> size_t {
+        auto iter = std::upper_bound(
+            f_versions.begin(), f_versions.end(), tk,
+            [](double t, const version& v) { return t < v.f_stop; }
+        );
+        return iter - f_versions.begin();
+    };
+    size_t v = (a_begin < a_end) ? find_version(t[a_begin]) : 0;
+    for (size_t k = a_begin; k < a_end; k++) {
+        if ((k > a_begin) && (t[k] < t[k-1])) {
+            v = find_version(t[k]);
+        }
+        while ((v < f_versions.size()) && (f_versions[v].f_stop <= t[k])) {
+            v++;
+        }
+        if ((v < f_versions.size()) && (f_versions[v].f_start <= t[k])) {
+            x[k] = f_versions[v].f_calibration(x[k]);
+        }
+        else {
+            x[k] = f_default(x[k]);
+        }
     }
 }
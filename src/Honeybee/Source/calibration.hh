@@ -9,7 +9,10 @@
 #define HONEYBEE_CALIBRATION_HH_ 1
 
 #include <string>
+#include <vector>
 #include <memory>
+#include <unordered_map>
+#include <cmath>
 #include "series.hh"
 #include "sensor_table.hh"
 #include "evaluator.hh"
@@ -20,10 +23,25 @@ namespace honeybee {
 
     class calibration {
       public:
-        calibration(): f_is_identity(false) {}
+        // Memoizing modes, selected by the "calibration_cache" entry of a channel:
+        //   memo[,LIMIT]:        cache outputs for each distinct input value (exact),
+        //                        up to LIMIT values (default e_default_memo_limit)
+        //   lut,MIN,MAX,STEP:    pre-evaluated table on a grid, linearly interpolated;
+        //                        inputs out of [MIN,MAX] are evaluated directly
+        enum cache_mode_t { e_cache_none, e_cache_memo, e_cache_lut };
+        enum { e_default_memo_limit = 1 << 16 };
+      public:
+        calibration(): f_is_identity(false), f_linearity(0), f_cache_mode(e_cache_none) {}
         calibration(const sensor& a_sensor, const sensor_table& a_sensor_table);
         int get_input_sensor() const { return f_input; }
+        // +1 (-1) if linear, a*x+b, with a >= 0 (a < 0), 0 otherwise; tested at construction at probe points //
+        int get_linearity() const { return f_linearity; }
         string get_description() const { return f_description; }
+        cache_mode_t get_cache_mode() const { return f_cache_mode; }
+        // Copies share the evaluation state (evaluator variables and memo), so calls on them must be //
+        // serialized (data_source does it with f_calibration_mutex); clone() makes an independent   //
+        // copy, with its own evaluator and an empty memo, to be used in another thread.              //
+        calibration clone() const;
         double operator()(double x) const {
             if (f_is_identity) {
                 return x;
@@ -31,14 +49,79 @@ namespace honeybee {
             if (! f_evaluator) {
                 return std::numeric_limits<double>::quiet_NaN();
             }
+            if (f_cache_mode == e_cache_lut) {
+                return lookup(x);
+            }
+            if (f_cache_mode == e_cache_memo) {
+                return memoize(x);
+            }
             return (*f_evaluator)(x);
         }
+      protected:
+        int find_linearity() const;
+        void setup_cache(const string& a_cache_description);
+        double lookup(double x) const {
+            double t_pos = (x - f_lut_min) / f_lut_step;
+            if (! (t_pos >= 0) || ! (t_pos <= f_lut->size()-1)) {
+                return (*f_evaluator)(x);
+            }
+            unsigned k = unsigned(t_pos);
+            if (k+1 >= f_lut->size()) {
+                return f_lut->back();
+            }
+            double t_frac = t_pos - k;
+            return (t_frac == 0) ? (*f_lut)[k] : (*f_lut)[k] + t_frac * ((*f_lut)[k+1] - (*f_lut)[k]);
+        }
+        double memoize(double x) const {
+            if (std::isnan(x)) {
+                return (*f_evaluator)(x);
+            }
+            auto iter = f_memo->find(x);
+            if (iter != f_memo->end()) {
+                return iter->second;
+            }
+            double y = (*f_evaluator)(x);
+            if (f_memo->size() < f_memo_limit) {
+                f_memo->emplace(x, y);
+            }
+            return y;
+        }
       protected:
         string f_description, f_variable_name;
         int f_input;
         bool f_is_identity;
+        int f_linearity;
         shared_ptr<evaluator> f_evaluator;
+      protected:
+        cache_mode_t f_cache_mode;
+        shared_ptr<unordered_map<double, double>> f_memo;
+        size_t f_memo_limit = e_default_memo_limit;
+        shared_ptr<vector<double>> f_lut;
+        double f_lut_min = 0, f_lut_step = 1;
     };
-    
+
+
+    // calibration with time-dependent versions, applied piecewise on a series //
+    class calibration_index {
+      public:
+        calibration_index() {}
+        calibration_index(const calibration& a_default): f_default(a_default) {}
+        bool add(double a_start, double a_stop, const calibration& a_calibration);  // false if overlapping
+        calibration_index clone() const;
+        int get_input_sensor() const { return f_default.get_input_sensor(); }
+        string get_description() const;
+        bool is_versioned() const { return ! f_versions.empty(); }
+        int get_linearity() const { return f_versions.empty() ? f_default.get_linearity() : 0; }
+        // applies to x[a_begin, a_end), with t being the timestamps of the series //
+        void apply(const vector<double>& t, vector<double>& x, size_t a_begin, size_t a_end) const;
+      protected:
+        struct version {
+            double f_start, f_stop;
+            calibration f_calibration;
+        };
+        calibration f_default;
+        vector<version> f_versions;  // sorted, non-overlapping
+    };
+
 }
 #endif
@@ -0,0 +1,369 @@
+/*
+ * columnar.cc
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sanshiro Enomoto <sanshiro@uw.edu>
+ */
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "columnar.hh"
+
+using namespace std;
+using namespace honeybee;
+
+
+static const char g_columnar_magic[8] = { 'H', 'B', 'C', 'O', 'L', 0, 0, 1 };
+static const uint64_t g_alignment = 64;
+
+
+namespace {
+    struct file_header {
+        char f_magic[8];
+        uint32_t f_number_of_columns, f_chunk_length;
+        uint64_t f_directory_offset, f_file_size;
+    };
+    struct directory_entry {
+        uint64_t f_name_offset;
+        uint32_t f_name_length, f_time_column;
+        double f_start, f_stop;
+        uint64_t f_length, f_t_offset, f_x_offset, f_stats_offset;
+    };
+    static_assert(sizeof(file_header) == 32, "unexpected padding in file_header");
+    static_assert(sizeof(directory_entry) == 64, "unexpected padding in directory_entry");
+    static_assert(sizeof(series_view::chunk_stats) == 24, "unexpected padding in chunk_stats");
+
+    bool is_little_endian()
+    {
+        uint16_t t_value = 1;
+        return *(const char*) &t_value == 1;
+    }
+
+    uint64_t aligned(uint64_t a_offset)
+    {
+        return (a_offset + g_alignment - 1) / g_alignment * g_alignment;
+    }
+
+    uint64_t number_of_chunks(uint64_t a_length, uint64_t a_chunk_length)
+    {
+        return (a_chunk_length == 0) ? 0 : (a_length + a_chunk_length - 1) / a_chunk_length;
+    }
+}
+
+
+
+columnar_writer::columnar_writer(unsigned a_chunk_length)
+{
+    f_chunk_length = a_chunk_length;
+}
+
+columnar_writer& columnar_writer::add(const string& a_name, const series& a_series)
+{
+    // consecutive columns with identical time points share one t array //
+    unsigned t_time_column = f_columns.size();
+    if (! f_columns.empty()) {
+        unsigned t_last = f_columns.back().f_time_column;
+        const vector<double>& t0 = f_columns[t_last].f_series->t();
+        const vector<double>& t1 = a_series.t();
+        if ((t0.size() == t1.size()) && (t0.empty() || (memcmp(t0.data(), t1.data(), t0.size() * sizeof(double)) == 0))) {
+            t_time_column = t_last;
+        }
+    }
+    f_columns.push_back({a_name, &a_series, t_time_column});
+
+    return *this;
+}
+
+columnar_writer& columnar_writer::add(const series_bundle& a_series_bundle)
+{
+    for (unsigned i = 0; i < a_series_bundle.size(); i++) {
+        add(a_series_bundle.keys()[i], a_series_bundle[i]);
+    }
+    return *this;
+}
+
+columnar_writer& columnar_writer::add(const data_frame& a_data_frame)
+{
+    return add(a_data_frame.columns());
+}
+
+void columnar_writer::write(ostream& os) const
+{
+    if (! is_little_endian()) {
+        throw std::runtime_error("hbcol: big-endian hosts are not supported");
+    }
+
+    //// Layout ////
+
+    file_header t_header;
+    memcpy(t_header.f_magic, g_columnar_magic, sizeof(g_columnar_magic));
+    t_header.f_number_of_columns = f_columns.size();
+    t_header.f_chunk_length = f_chunk_length;
+    t_header.f_directory_offset = sizeof(file_header);
+
+    vector<directory_entry> t_directory(f_columns.size());
+    uint64_t t_offset = t_header.f_directory_offset + t_directory.size() * sizeof(directory_entry);
+    for (unsigned i = 0; i < f_columns.size(); i++) {
+        t_directory[i].f_name_offset = t_offset;
+        t_directory[i].f_name_length = f_columns[i].f_name.size();
+        t_offset += f_columns[i].f_name.size();
+    }
+    for (unsigned i = 0; i < f_columns.size(); i++) {
+        const series& t_series = *f_columns[i].f_series;
+        directory_entry& t_entry = t_directory[i];
+        t_entry.f_time_column = f_columns[i].f_time_column;
+        t_entry.f_start = t_series.get_start();
+        t_entry.f_stop = t_series.get_stop();
+        t_entry.f_length = t_series.size();
+        if (t_entry.f_time_column == i) {
+            t_entry.f_t_offset = t_offset = aligned(t_offset);
+            t_offset += t_entry.f_length * sizeof(double);
+        }
+        else {
+            t_entry.f_t_offset = t_directory[t_entry.f_time_column].f_t_offset;
+        }
+        t_entry.f_x_offset = t_offset = aligned(t_offset);
+        t_offset += t_entry.f_length * sizeof(double);
+    }
+    for (auto& t_entry: t_directory) {
+        if (f_chunk_length == 0) {
+            t_entry.f_stats_offset = 0;
+            continue;
+        }
+        t_entry.f_stats_offset = t_offset = aligned(t_offset);
+        t_offset += number_of_chunks(t_entry.f_length, f_chunk_length) * sizeof(series_view::chunk_stats);
+    }
+    t_header.f_file_size = t_offset;
+
+
+    //// Contents ////
+
+    uint64_t t_position = 0;
+    auto put = [&](const void* a_data, uint64_t a_size) {
+        os.write((const char*) a_data, a_size);
+        t_position += a_size;
+    };
+    auto pad_to = [&](uint64_t a_offset) {
+        static const char t_zeros[g_alignment] = { 0 };
+        while (t_position < a_offset) {
+            put(t_zeros, std::min<uint64_t>(a_offset - t_position, g_alignment));
+        }
+    };
+
+    put(&t_header, sizeof(t_header));
+    put(t_directory.data(), t_directory.size() * sizeof(directory_entry));
+    for (const auto& t_column: f_columns) {
+        put(t_column.f_name.data(), t_column.f_name.size());
+    }
+    for (unsigned i = 0; i < f_columns.size(); i++) {
+        const series& t_series = *f_columns[i].f_series;
+        if (f_columns[i].f_time_column == i) {
+            pad_to(t_directory[i].f_t_offset);
+            put(t_series.t().data(), t_series.size() * sizeof(double));
+        }
+        pad_to(t_directory[i].f_x_offset);
+        put(t_series.x().data(), t_series.size() * sizeof(double));
+    }
+    for (unsigned i = 0; i < f_columns.size(); i++) {
+        if (f_chunk_length == 0) {
+            break;
+        }
+        pad_to(t_directory[i].f_stats_offset);
+        const vector<double>& x = f_columns[i].f_series->x();
+        for (size_t t_begin = 0; t_begin < x.size(); t_begin += f_chunk_length) {
+            size_t t_end = std::min<size_t>(t_begin + f_chunk_length, x.size());
+            series_view::chunk_stats t_stats = {
+                std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::quiet_NaN(), 0
+            };
+            for (size_t k = t_begin; k < t_end; k++) {
+                if (std::isnan(x[k])) {
+                    continue;
+                }
+                if (t_stats.f_count++ == 0) {
+                    t_stats.f_min = t_stats.f_max = x[k];
+                }
+                else {
+                    t_stats.f_min = std::min(t_stats.f_min, x[k]);
+                    t_stats.f_max = std::max(t_stats.f_max, x[k]);
+                }
+            }
+            put(&t_stats, sizeof(t_stats));
+        }
+    }
+    pad_to(t_header.f_file_size);
+
+    if (! os) {
+        throw std::runtime_error("hbcol: write error");
+    }
+}
+
+void columnar_writer::save(const string& a_path) const
+{
+    // written to a temporary file and renamed, so that readers never see a partial file //
+    string t_temporary_path = a_path + ".tmp" + to_string(getpid());
+    {
+        ofstream t_output(t_temporary_path, ios::binary);
+        if (! t_output) {
+            throw std::runtime_error("hbcol: unable to create file: " + t_temporary_path);
+        }
+        try {
+            write(t_output);
+            t_output.close();
+            if (! t_output) {
+                throw std::runtime_error("hbcol: write error: " + t_temporary_path);
+            }
+        }
+        catch (...) {
+            remove(t_temporary_path.c_str());
+            throw;
+        }
+    }
+    if (rename(t_temporary_path.c_str(), a_path.c_str()) != 0) {
+        remove(t_temporary_path.c_str());
+        throw std::runtime_error("hbcol: unable to write file: " + a_path);
+    }
+}
+
+
+
+series series_view::to_series() const
+{
+    series t_series(f_start, f_stop);
+    t_series.t().assign(f_t, f_t + f_length);
+    t_series.x().assign(f_x, f_x + f_length);
+
+    return t_series;
+}
+
+
+
+columnar_file::columnar_file()
+{
+    f_map = nullptr;
+    f_size = 0;
+}
+
+columnar_file::columnar_file(const string& a_path)
+: columnar_file()
+{
+    open(a_path);
+}
+
+columnar_file::~columnar_file()
+{
+    close();
+}
+
+void columnar_file::close()
+{
+    if (f_map) {
+        munmap(f_map, f_size);
+    }
+    f_map = nullptr;
+    f_size = 0;
+    f_columns.clear();
+}
+
+void columnar_file::open(const string& a_path)
+{
+    close();
+    if (! is_little_endian()) {
+        throw std::runtime_error("hbcol: big-endian hosts are not supported");
+    }
+
+    int t_fd = ::open(a_path.c_str(), O_RDONLY);
+    if (t_fd < 0) {
+        throw std::runtime_error("hbcol: unable to open file: " + a_path);
+    }
+    struct stat t_stat;
+    if ((fstat(t_fd, &t_stat) != 0) || (t_stat.st_size < (off_t) sizeof(file_header))) {
+        ::close(t_fd);
+        throw std::runtime_error("hbcol: not an hbcol file: " + a_path);
+    }
+    size_t t_size = t_stat.st_size;
+    void* t_map = mmap(nullptr, t_size, PROT_READ, MAP_SHARED, t_fd, 0);
+    ::close(t_fd);
+    if (t_map == MAP_FAILED) {
+        throw std::runtime_error("hbcol: unable to map file: " + a_path);
+    }
+    f_map = t_map;
+    f_size = t_size;
+
+    const char* t_data = (const char*) f_map;
+    auto check = [&](bool a_condition, const char* a_message) {
+        if (! a_condition) {
+            close();
+            throw std::runtime_error(string("hbcol: ") + a_message + ": " + a_path);
+        }
+    };
+    // offsets and sizes from the file are checked against the file size, without overflows //
+    auto is_inside = [&](uint64_t a_offset, uint64_t a_count, uint64_t a_item_size) {
+        return (a_offset <= t_size) && (a_count <= (t_size - a_offset) / a_item_size);
+    };
+
+    file_header t_header;
+    memcpy(&t_header, t_data, sizeof(t_header));
+    check(memcmp(t_header.f_magic, g_columnar_magic, sizeof(g_columnar_magic)) == 0, "not an hbcol file");
+    check(t_header.f_file_size == t_size, "truncated file");
+    check(is_inside(t_header.f_directory_offset, t_header.f_number_of_columns, sizeof(directory_entry)), "broken directory");
+
+    f_columns.resize(t_header.f_number_of_columns);
+    for (unsigned i = 0; i < t_header.f_number_of_columns; i++) {
+        directory_entry t_entry;
+        memcpy(&t_entry, t_data + t_header.f_directory_offset + i * sizeof(directory_entry), sizeof(t_entry));
+        check(is_inside(t_entry.f_name_offset, t_entry.f_name_length, 1), "broken column name");
+        check(is_inside(t_entry.f_t_offset, t_entry.f_length, sizeof(double)), "broken time array");
+        check(is_inside(t_entry.f_x_offset, t_entry.f_length, sizeof(double)), "broken value array");
+        check((t_entry.f_t_offset % sizeof(double) == 0) && (t_entry.f_x_offset % sizeof(double) == 0), "misaligned array");
+
+        series_view& t_view = f_columns[i];
+        t_view.f_name.assign(t_data + t_entry.f_name_offset, t_entry.f_name_length);
+        t_view.f_start = t_entry.f_start;
+        t_view.f_stop = t_entry.f_stop;
+        t_view.f_length = t_entry.f_length;
+        t_view.f_t = (const double*) (t_data + t_entry.f_t_offset);
+        t_view.f_x = (const double*) (t_data + t_entry.f_x_offset);
+        t_view.f_chunk_length = t_header.f_chunk_length;
+        t_view.f_number_of_chunks = number_of_chunks(t_entry.f_length, t_header.f_chunk_length);
+        t_view.f_stats = nullptr;
+        if (t_view.f_number_of_chunks > 0) {
+            check(is_inside(t_entry.f_stats_offset, t_view.f_number_of_chunks, sizeof(series_view::chunk_stats)), "broken statistics");
+            check(t_entry.f_stats_offset % sizeof(double) == 0, "misaligned statistics");
+            t_view.f_stats = (const series_view::chunk_stats*) (t_data + t_entry.f_stats_offset);
+        }
+    }
+}
+
+const series_view& columnar_file::operator[](const string& a_name) const
+{
+    for (const auto& t_column: f_columns) {
+        if (t_column.get_name() == a_name) {
+            return t_column;
+        }
+    }
+    throw std::out_of_range("hbcol: no such column: " + a_name);
+}
+
+series_bundle columnar_file::to_series_bundle() const
+{
+    vector<string> t_names;
+    vector<series> t_series_list;
+    for (const auto& t_column: f_columns) {
+        t_names.push_back(t_column.get_name());
+        t_series_list.push_back(t_column.to_series());
+    }
+
+    return hb::zip(std::move(t_names), std::move(t_series_list));
+}
@@ -0,0 +1,101 @@
+/*
+ * columnar.hh
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sanshiro Enomoto <sanshiro@uw.edu>
+ */
+
+#ifndef HONEYBEE_COLUMNAR_HH_
+#define HONEYBEE_COLUMNAR_HH_ 1
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <cstdint>
+#include "series.hh"
+
+
+namespace honeybee {
+    using namespace std;
+
+    // "hbcol" binary columnar file of series, to be mapped and read without parsing.
+    //
+    // Layout (little-endian; offsets from the file start):
+    //   header      char[8] "HBCOL\0\0\1", u32 number_of_columns, u32 chunk_length, u64 directory_offset, u64 file_size
+    //   directory   per column (64 bytes): u64 name_offset, u32 name_length, u32 time_column,
+    //               f64 start, f64 stop, u64 length, u64 t_offset, u64 x_offset, u64 stats_offset
+    //   names       UTF-8, not terminated
+    //   arrays      f64[length] of t and x per column, each aligned to 64 bytes;
+    //               columns with the same time points (data frame) refer to one t array (time_column)
+    //   statistics  per chunk of chunk_length points: f64 min, f64 max, u64 count (non-NaN values of x);
+    //               stats_offset is 0 if chunk_length is 0
+    class columnar_writer {
+      public:
+        columnar_writer(unsigned a_chunk_length=4096);  // 0 for no chunk statistics
+        // the series are referred to, not copied, until write() //
+        columnar_writer& add(const string& a_name, const series& a_series);
+        columnar_writer& add(const series_bundle& a_series_bundle);
+        columnar_writer& add(const data_frame& a_data_frame);
+        void write(ostream& os) const;
+        void save(const string& a_path) const;
+      protected:
+        struct column {
+            string f_name;
+            const series* f_series;
+            unsigned f_time_column;
+        };
+        unsigned f_chunk_length;
+        vector<column> f_columns;
+    };
+
+
+    // a series on the mapped file: pointers are valid while the columnar_file is open //
+    class series_view {
+      public:
+        struct chunk_stats {
+            double f_min, f_max;
+            uint64_t f_count;
+        };
+      public:
+        const string& get_name() const { return f_name; }
+        double get_start() const { return f_start; }
+        double get_stop() const { return f_stop; }
+        size_t size() const { return f_length; }
+        const double* t() const { return f_t; }
+        const double* x() const { return f_x; }
+        size_t number_of_chunks() const { return f_number_of_chunks; }
+        size_t chunk_length() const { return f_chunk_length; }
+        const chunk_stats& chunk(size_t a_index) const { return f_stats[a_index]; }
+        series to_series() const;  // copy
+      protected:
+        friend class columnar_file;
+        string f_name;
+        double f_start, f_stop;
+        size_t f_length;
+        const double* f_t;
+        const double* f_x;
+        size_t f_chunk_length, f_number_of_chunks;
+        const chunk_stats* f_stats;
+    };
+
+
+    class columnar_file {
+      public:
+        columnar_file();
+        explicit columnar_file(const string& a_path);
+        ~columnar_file();
+        columnar_file(const columnar_file&) = delete;
+        columnar_file& operator=(const columnar_file&) = delete;
+        void open(const string& a_path);  // throws std::runtime_error on broken files
+        void close();
+        const vector<series_view>& columns() const { return f_columns; }
+        const series_view& operator[](const string& a_name) const;
+        series_bundle to_series_bundle() const;  // copy
+      protected:
+        void* f_map;
+        size_t f_size;
+        vector<series_view> f_columns;
+    };
+
+}
+#endif
@@ -0,0 +1,505 @@
+/*
+ * compression.cc
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sanshiro Enomoto <sanshiro@uw.edu>
+ */
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <unistd.h>
+#include "compression.hh"
+
+using namespace std;
+using namespace honeybee;
+
+
+static const char g_compressed_bundle_magic[8] = { 'H', 'B', 'G', 'O', 'R', 'L', 0, 1 };
+
+
+namespace {
+    class bit_writer {
+      public:
+        bit_writer(string& a_data): f_data(a_data), f_buffer(0), f_number_of_bits(0) {}
+        // the lower a_width bits of a_value, MSB first //
+        void put(uint64_t a_value, unsigned a_width) {
+            if (a_width == 0) {
+                return;
+            }
+            if (a_width < 64) {
+                a_value &= (uint64_t(1) << a_width) - 1;
+            }
+            unsigned t_room = 64 - f_number_of_bits;
+            if (a_width < t_room) {
+                f_buffer |= a_value << (t_room - a_width);
+                f_number_of_bits += a_width;
+                return;
+            }
+            unsigned t_rest = a_width - t_room;
+            f_buffer |= a_value >> t_rest;
+            flush_word();
+            if (t_rest > 0) {
+                f_buffer = a_value << (64 - t_rest);
+                f_number_of_bits = t_rest;
+            }
+        }
+        void finish() {
+            for (unsigned k = 0; k < (f_number_of_bits + 7) / 8; k++) {
+                f_data.push_back(char(f_buffer >> (56 - 8 * k)));
+            }
+            f_buffer = 0;
+            f_number_of_bits = 0;
+        }
+      protected:
+        void flush_word() {
+            for (unsigned k = 0; k < 8; k++) {
+                f_data.push_back(char(f_buffer >> (56 - 8 * k)));
+            }
+            f_buffer = 0;
+            f_number_of_bits = 0;
+        }
+        string& f_data;
+        uint64_t f_buffer;
+        unsigned f_number_of_bits;
+    };
+
+    class bit_reader {
+      public:
+        bit_reader(const string& a_data): f_data((const uint8_t*) a_data.data()), f_size(8 * a_data.size()), f_position(0) {}
+        uint64_t get(unsigned a_width) {
+            if (a_width > f_size - f_position) {
+                throw std::runtime_error("compressed series: truncated block");
+            }
+            uint64_t t_value = 0;
+            while (a_width > 0) {
+                unsigned t_available = 8 - (f_position & 7);
+                unsigned t_taken = std::min(t_available, a_width);
+                uint64_t t_bits = (f_data[f_position >> 3] >> (t_available - t_taken)) & ((1u << t_taken) - 1);
+                t_value = (t_value << t_taken) | t_bits;
+                f_position += t_taken;
+                a_width -= t_taken;
+            }
+            return t_value;
+        }
+        int64_t get_signed(unsigned a_width) {
+            uint64_t t_value = get(a_width);
+            if ((a_width < 64) && (t_value >> (a_width - 1))) {
+                t_value |= ~uint64_t(0) << a_width;
+            }
+            return (int64_t) t_value;
+        }
+      protected:
+        const uint8_t* f_data;
+        size_t f_size, f_position;
+    };
+
+
+    // value XOR the previous value: '0' for the same value, '10' + bits in the previous
+    // window of meaningful bits, or '11' + 5-bit leading zeros + 6-bit length + bits //
+    struct xor_state {
+        uint64_t f_previous = 0;
+        unsigned f_leading = 0, f_trailing = 0;
+        bool f_has_window = false;
+    };
+
+    uint64_t bits_of(double a_value)
+    {
+        uint64_t t_bits;
+        memcpy(&t_bits, &a_value, sizeof(t_bits));
+        return t_bits;
+    }
+
+    double double_of(uint64_t a_bits)
+    {
+        double t_value;
+        memcpy(&t_value, &a_bits, sizeof(t_value));
+        return t_value;
+    }
+
+    void put_xor(bit_writer& a_writer, xor_state& a_state, double a_value)
+    {
+        uint64_t t_bits = bits_of(a_value);
+        uint64_t t_xor = t_bits ^ a_state.f_previous;
+        a_state.f_previous = t_bits;
+        if (t_xor == 0) {
+            a_writer.put(0, 1);
+            return;
+        }
+        unsigned t_leading = std::min(__builtin_clzll(t_xor), 31);
+        unsigned t_trailing = __builtin_ctzll(t_xor);
+        if (a_state.f_has_window && (t_leading >= a_state.f_leading) && (t_trailing >= a_state.f_trailing)) {
+            a_writer.put(0x2, 2);
+            a_writer.put(t_xor >> a_state.f_trailing, 64 - a_state.f_leading - a_state.f_trailing);
+            return;
+        }
+        unsigned t_length = 64 - t_leading - t_trailing;
+        a_writer.put(0x3, 2);
+        a_writer.put(t_leading, 5);
+        a_writer.put(t_length - 1, 6);
+        a_writer.put(t_xor >> t_trailing, t_length);
+        a_state.f_leading = t_leading;
+        a_state.f_trailing = t_trailing;
+        a_state.f_has_window = true;
+    }
+
+    double get_xor(bit_reader& a_reader, xor_state& a_state)
+    {
+        if (a_reader.get(1) == 0) {
+            return double_of(a_state.f_previous);
+        }
+        if (a_reader.get(1) == 0) {
+            if (! a_state.f_has_window) {
+                throw std::runtime_error("compressed series: broken block");
+            }
+        }
+        else {
+            unsigned t_leading = a_reader.get(5);
+            unsigned t_length = a_reader.get(6) + 1;
+            if (t_leading + t_length > 64) {
+                throw std::runtime_error("compressed series: broken block");
+            }
+            a_state.f_leading = t_leading;
+            a_state.f_trailing = 64 - t_leading - t_length;
+            a_state.f_has_window = true;
+        }
+        unsigned t_length = 64 - a_state.f_leading - a_state.f_trailing;
+        a_state.f_previous ^= a_reader.get(t_length) << a_state.f_trailing;
+        return double_of(a_state.f_previous);
+    }
+
+
+    // delta-of-delta of ticks: '0' for a steady interval, or a prefix and a signed value //
+    void put_delta_of_delta(bit_writer& a_writer, int64_t a_value)
+    {
+        if (a_value == 0) {
+            a_writer.put(0, 1);
+        }
+        else if ((a_value >= -64) && (a_value < 64)) {
+            a_writer.put(0x2, 2);
+            a_writer.put(a_value, 7);
+        }
+        else if ((a_value >= -2048) && (a_value < 2048)) {
+            a_writer.put(0x6, 3);
+            a_writer.put(a_value, 12);
+        }
+        else if ((a_value >= -(1 << 19)) && (a_value < (1 << 19))) {
+            a_writer.put(0xe, 4);
+            a_writer.put(a_value, 20);
+        }
+        else {
+            a_writer.put(0xf, 4);
+            a_writer.put(a_value, 64);
+        }
+    }
+
+    int64_t get_delta_of_delta(bit_reader& a_reader)
+    {
+        if (a_reader.get(1) == 0) {
+            return 0;
+        }
+        if (a_reader.get(1) == 0) {
+            return a_reader.get_signed(7);
+        }
+        if (a_reader.get(1) == 0) {
+            return a_reader.get_signed(12);
+        }
+        if (a_reader.get(1) == 0) {
+            return a_reader.get_signed(20);
+        }
+        return a_reader.get_signed(64);
+    }
+
+    int64_t gcd(int64_t a, int64_t b)
+    {
+        a = std::abs(a);
+        b = std::abs(b);
+        while (b != 0) {
+            int64_t r = a % b;
+            a = b;
+            b = r;
+        }
+        return a;
+    }
+
+    // microseconds, if the time is exactly one (as parsed from a decimal text with 6 digits) //
+    bool to_microseconds(double a_time, int64_t& a_ticks)
+    {
+        if (! (std::fabs(a_time) < 1e12)) {
+            return false;
+        }
+        a_ticks = std::llround(a_time * 1e6);
+        return double(a_ticks) / 1e6 == a_time;
+    }
+}
+
+
+
+compressed_series::compressed_series(unsigned a_block_length)
+{
+    f_block_length = std::max(1u, a_block_length);
+    f_start = f_stop = 0;
+    f_size = 0;
+}
+
+compressed_series::compressed_series(const series& a_series, unsigned a_block_length)
+: compressed_series(a_block_length)
+{
+    f_start = a_series.get_start();
+    f_stop = a_series.get_stop();
+    f_size = a_series.size();
+    for (size_t t_begin = 0; t_begin < f_size; t_begin += f_block_length) {
+        f_blocks.emplace_back();
+        encode(a_series, t_begin, std::min<size_t>(t_begin + f_block_length, f_size), f_blocks.back());
+    }
+}
+
+size_t compressed_series::byte_size() const
+{
+    size_t t_size = sizeof(*this);
+    for (const auto& t_block: f_blocks) {
+        t_size += sizeof(block) + t_block.f_data.size();
+    }
+    return t_size;
+}
+
+void compressed_series::encode(const series& a_series, size_t a_begin, size_t a_end, block& a_block) const
+{
+    const vector<double>& t = a_series.t();
+    const vector<double>& x = a_series.x();
+    a_block.f_t0 = t[a_begin];
+    a_block.f_x0 = x[a_begin];
+    a_block.f_count = a_end - a_begin;
+
+    // ticks are used only if all the times are restored exactly //
+    vector<int64_t> t_ticks(a_end - a_begin);
+    bool t_is_ticks = true;
+    int64_t t_tick = 0;
+    for (size_t k = a_begin; k < a_end && t_is_ticks; k++) {
+        t_is_ticks = to_microseconds(t[k], t_ticks[k - a_begin]);
+        if (t_is_ticks && (k > a_begin)) {
+            t_tick = gcd(t_tick, t_ticks[k - a_begin] - t_ticks[k - a_begin - 1]);
+        }
+    }
+    a_block.f_time_encoding = t_is_ticks ? e_time_ticks : e_time_xor;
+    a_block.f_tick = std::max<int64_t>(t_tick, 1);
+
+    bit_writer t_writer(a_block.f_data);
+    xor_state t_time_state, t_value_state;
+    t_time_state.f_previous = bits_of(a_block.f_t0);
+    t_value_state.f_previous = bits_of(a_block.f_x0);
+    int64_t t_previous_delta = 0;
+    for (size_t k = a_begin + 1; k < a_end; k++) {
+        if (t_is_ticks) {
+            int64_t t_delta = (t_ticks[k - a_begin] - t_ticks[k - a_begin - 1]) / a_block.f_tick;
+            put_delta_of_delta(t_writer, t_delta - t_previous_delta);
+            t_previous_delta = t_delta;
+        }
+        else {
+            put_xor(t_writer, t_time_state, t[k]);
+        }
+        put_xor(t_writer, t_value_state, x[k]);
+    }
+    t_writer.finish();
+    a_block.f_data.shrink_to_fit();
+}
+
+void compressed_series::decode(const block& a_block, series& a_series, double a_from, double a_to) const
+{
+    bit_reader t_reader(a_block.f_data);
+    xor_state t_time_state, t_value_state;
+    t_time_state.f_previous = bits_of(a_block.f_t0);
+    t_value_state.f_previous = bits_of(a_block.f_x0);
+    int64_t t_ticks = std::llround(a_block.f_t0 * 1e6);
+    int64_t t_delta = 0;
+
+    double tk = a_block.f_t0, xk = a_block.f_x0;
+    for (uint32_t k = 0; k < a_block.f_count; k++) {
+        if (k > 0) {
+            if (a_block.f_time_encoding == e_time_ticks) {
+                t_delta += get_delta_of_delta(t_reader);
+                t_ticks += t_delta * a_block.f_tick;
+                tk = double(t_ticks) / 1e6;
+            }
+            else {
+                tk = get_xor(t_reader, t_time_state);
+            }
+            xk = get_xor(t_reader, t_value_state);
+        }
+        if ((tk >= a_from) && (tk < a_to)) {
+            a_series.emplace_back(tk, xk);
+        }
+    }
+}
+
+series compressed_series::decompress() const
+{
+    const double t_inf = std::numeric_limits<double>::infinity();
+    series t_series(f_start, f_stop);
+    t_series.t().reserve(f_size);
+    t_series.x().reserve(f_size);
+    for (const auto& t_block: f_blocks) {
+        decode(t_block, t_series, -t_inf, +t_inf);
+    }
+
+    return t_series;
+}
+
+series compressed_series::decompress(double a_from, double a_to) const
+{
+    // blocks are in time order; a block ends before the first point of the next //
+    series t_series(std::max(f_start, a_from), std::min(f_stop, a_to));
+    for (size_t i = 0; i < f_blocks.size(); i++) {
+        if ((i + 1 < f_blocks.size()) && (f_blocks[i+1].f_t0 < a_from)) {
+            continue;
+        }
+        if (f_blocks[i].f_t0 >= a_to) {
+            break;
+        }
+        decode(f_blocks[i], t_series, a_from, a_to);
+    }
+
+    return t_series;
+}
+
+
+
+compressed_bundle::compressed_bundle(const series_bundle& a_series_bundle, unsigned a_block_length)
+{
+    for (unsigned i = 0; i < a_series_bundle.size(); i++) {
+        f_names.push_back(a_series_bundle.keys()[i]);
+        f_series_list.emplace_back(a_series_bundle[i], a_block_length);
+    }
+}
+
+series_bundle compressed_bundle::decompress() const
+{
+    vector<string> t_names = f_names;
+    vector<series> t_series_list;
+    for (const auto& t_series: f_series_list) {
+        t_series_list.push_back(t_series.decompress());
+    }
+
+    return hb::zip(std::move(t_names), std::move(t_series_list));
+}
+
+size_t compressed_bundle::byte_size() const
+{
+    size_t t_size = 0;
+    for (unsigned i = 0; i < f_names.size(); i++) {
+        t_size += f_names[i].size() + f_series_list[i].byte_size();
+    }
+    return t_size;
+}
+
+void compressed_bundle::save(const string& a_path) const
+{
+    // little-endian fields, as the snapshot files //
+    string t_buffer(g_compressed_bundle_magic, sizeof(g_compressed_bundle_magic));
+    auto put = [&](const void* a_data, size_t a_size) {
+        t_buffer.append((const char*) a_data, a_size);
+    };
+    auto put_u32 = [&](uint32_t a_value) { put(&a_value, sizeof(a_value)); };
+    auto put_f64 = [&](double a_value) { put(&a_value, sizeof(a_value)); };
+
+    put_u32(f_names.size());
+    for (unsigned i = 0; i < f_names.size(); i++) {
+        const compressed_series& t_series = f_series_list[i];
+        put_u32(f_names[i].size());
+        put(f_names[i].data(), f_names[i].size());
+        put_f64(t_series.f_start);
+        put_f64(t_series.f_stop);
+        put_u32(t_series.f_block_length);
+        put_u32(t_series.f_blocks.size());
+        for (const auto& t_block: t_series.f_blocks) {
+            put_f64(t_block.f_t0);
+            put_f64(t_block.f_x0);
+            put_u32(t_block.f_count);
+            put_u32(t_block.f_time_encoding);
+            put(&t_block.f_tick, sizeof(t_block.f_tick));
+            put_u32(t_block.f_data.size());
+            put(t_block.f_data.data(), t_block.f_data.size());
+        }
+    }
+
+    string t_temporary_path = a_path + ".tmp" + to_string(getpid());
+    ofstream t_output(t_temporary_path, ios::binary);
+    t_output.write(t_buffer.data(), t_buffer.size());
+    t_output.close();
+    if (! t_output || (rename(t_temporary_path.c_str(), a_path.c_str()) != 0)) {
+        remove(t_temporary_path.c_str());
+        throw std::runtime_error("unable to write compressed series file: " + a_path);
+    }
+}
+
+void compressed_bundle::load(const string& a_path)
+{
+    ifstream t_input(a_path, ios::binary);
+    if (! t_input) {
+        throw std::runtime_error("unable to open compressed series file: " + a_path);
+    }
+    ostringstream t_contents;
+    t_contents << t_input.rdbuf();
+    const string t_buffer = t_contents.str();
+
+    size_t t_position = 0;
+    auto take = [&](void* a_data, size_t a_size) {
+        if (t_buffer.size() - t_position < a_size) {
+            throw std::runtime_error("truncated compressed series file: " + a_path);
+        }
+        memcpy(a_data, t_buffer.data() + t_position, a_size);
+        t_position += a_size;
+    };
+    auto get_u32 = [&]() { uint32_t t_value; take(&t_value, sizeof(t_value)); return t_value; };
+    auto get_f64 = [&]() { double t_value; take(&t_value, sizeof(t_value)); return t_value; };
+    auto get_string = [&]() {
+        string t_value(get_u32(), '\0');
+        take(&t_value[0], t_value.size());
+        return t_value;
+    };
+
+    char t_magic[sizeof(g_compressed_bundle_magic)];
+    take(t_magic, sizeof(t_magic));
+    if (memcmp(t_magic, g_compressed_bundle_magic, sizeof(t_magic)) != 0) {
+        throw std::runtime_error("not a compressed series file: " + a_path);
+    }
+
+    vector<string> t_names;
+    vector<compressed_series> t_series_list;
+    uint32_t t_number_of_series = get_u32();
+    for (uint32_t i = 0; i < t_number_of_series; i++) {
+        t_names.push_back(get_string());
+        double t_start = get_f64();
+        double t_stop = get_f64();
+        compressed_series t_series(get_u32());
+        t_series.f_start = t_start;
+        t_series.f_stop = t_stop;
+        uint32_t t_number_of_blocks = get_u32();
+        for (uint32_t k = 0; k < t_number_of_blocks; k++) {
+            compressed_series::block t_block;
+            t_block.f_t0 = get_f64();
+            t_block.f_x0 = get_f64();
+            t_block.f_count = get_u32();
+            t_block.f_time_encoding = get_u32();
+            take(&t_block.f_tick, sizeof(t_block.f_tick));
+            t_block.f_data = get_string();
+            if ((t_block.f_count == 0) || (t_block.f_time_encoding > compressed_series::e_time_xor) || (t_block.f_tick < 1)) {
+                throw std::runtime_error("broken compressed series file: " + a_path);
+            }
+            t_series.f_size += t_block.f_count;
+            t_series.f_blocks.push_back(std::move(t_block));
+        }
+        t_series_list.push_back(std::move(t_series));
+    }
+
+    f_names = std::move(t_names);
+    f_series_list = std::move(t_series_list);
+}
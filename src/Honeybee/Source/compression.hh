@@ -0,0 +1,73 @@
+/*
+ * compression.hh
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sanshiro Enomoto <sanshiro@uw.edu>
+ */
+
+#ifndef HONEYBEE_COMPRESSION_HH_
+#define HONEYBEE_COMPRESSION_HH_ 1
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "series.hh"
+
+
+namespace honeybee {
+    using namespace std;
+
+    // Lossless Gorilla-style encoding of a series, in independently decodable blocks:
+    // - time: delta-of-delta of integer ticks (the GCD of the intervals in microseconds), if the times are
+    //   exactly microseconds (as from the database); otherwise XOR of the IEEE bits as the values.
+    // - value: XOR with the previous value, storing only the meaningful bits.
+    // Steady intervals and unchanged values take one bit each.
+    class compressed_series {
+      public:
+        compressed_series(unsigned a_block_length=1024);
+        explicit compressed_series(const series& a_series, unsigned a_block_length=1024);
+        series decompress() const;
+        series decompress(double a_from, double a_to) const;  // decodes only the blocks in the range
+        double get_start() const { return f_start; }
+        double get_stop() const { return f_stop; }
+        size_t size() const { return f_size; }
+        size_t number_of_blocks() const { return f_blocks.size(); }
+        size_t byte_size() const;  // encoded size
+      protected:
+        friend class compressed_bundle;
+        enum time_encoding_t { e_time_ticks = 0, e_time_xor = 1 };
+        struct block {
+            double f_t0, f_x0;  // first point, as is
+            uint32_t f_count;
+            uint32_t f_time_encoding;
+            int64_t f_tick;     // in microseconds, for e_time_ticks
+            string f_data;      // bit stream of the following points
+        };
+        void encode(const series& a_series, size_t a_begin, size_t a_end, block& a_block) const;
+        void decode(const block& a_block, series& a_series, double a_from, double a_to) const;
+      protected:
+        unsigned f_block_length;
+        double f_start, f_stop;
+        size_t f_size;
+        vector<block> f_blocks;
+    };
+
+
+    // named set of compressed series, with a binary file format //
+    class compressed_bundle {
+      public:
+        compressed_bundle() {}
+        explicit compressed_bundle(const series_bundle& a_series_bundle, unsigned a_block_length=1024);
+        series_bundle decompress() const;
+        const vector<string>& names() const { return f_names; }
+        const vector<compressed_series>& series_list() const { return f_series_list; }
+        size_t byte_size() const;
+        void save(const string& a_path) const;
+        void load(const string& a_path);  // throws std::runtime_error on broken files
+      protected:
+        vector<string> f_names;
+        vector<compressed_series> f_series_list;
+    };
+
+}
+#endif
@@ -10,9 +10,25 @@
 #include <map>
 #include <set>
 #include <regex>
+#include <thread>
+#include <exception>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <fstream>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "sensor_table.hh"
 #include "pgsql.hh"
+#include "rollup.hh"
 #include "data_source.hh"
+#include "metrics.hh"
 
 using namespace std;
 using namespace honeybee;
@@ -40,63 +56,249 @@ void data_source::bind(sensor_table& a_sensor_table)
 {
     hINFO(cerr << "Calibration Chain:" << endl);
     for (int t_sensor_number: a_sensor_table.find_like({{}})) {
-        auto& t_sensor = a_sensor_table[t_sensor_number];
-        if (t_sensor.get_calibration().empty()) {
-            continue;
-        }
-        f_calibration_table[t_sensor_number] = calibration(t_sensor, a_sensor_table);
-        hINFO(cerr
-              << "    " << t_sensor.get_name().join(".") << " <= "
-              << a_sensor_table[f_calibration_table[t_sensor_number].get_input_sensor()].get_name().join(".") << " : "
-              << f_calibration_table[t_sensor_number].get_description() << endl
-        );
+        bind_calibration(a_sensor_table[t_sensor_number], a_sensor_table);
     }
     
     this->bind_inputs(a_sensor_table);
 }
 
+bool data_source::is_assigned_elsewhere(const sensor& a_sensor) const
+{
+    if (f_source_name.empty()) {
+        return false;
+    }
+    string t_data_source = a_sensor.get_option("data_source", "");
+    
+    return ! t_data_source.empty() && (t_data_source != f_source_name);
+}
+
+void data_source::bind_lazily(shared_ptr<const sensor_table> a_sensor_table)
+{
+    f_lazy_sensor_table = a_sensor_table;
+}
+
+bool data_source::resolve(const vector<int>& a_sensor_list)
+{
+    if (! f_lazy_sensor_table) {
+        return true;
+    }
+    
+    // each sensor is resolved once, with its calibration chain down to the input bound to the data store //
+    std::lock_guard<std::mutex> t_lock(f_binding_mutex);
+    const sensor_table& t_sensor_table = *f_lazy_sensor_table;
+    for (int t_number: a_sensor_list) {
+        while (t_number && (f_resolved_sensors.count(t_number) == 0)) {
+            const sensor& t_sensor = t_sensor_table[t_number];
+            if (! t_sensor) {
+                break;
+            }
+            if (! t_sensor.get_calibration().empty()) {
+                bind_calibration(t_sensor, t_sensor_table);
+                f_resolved_sensors.insert(t_number);
+                t_number = f_calibration_table[t_number].get_input_sensor();
+                continue;
+            }
+            if (! this->bind_input(t_sensor)) {
+                hINFO(cerr << "unable to bind lazily: " << t_sensor.get_name().join(".") << endl);
+                return false;
+            }
+            f_resolved_sensors.insert(t_number);
+        }
+    }
+
+    return true;
+}
+
+void data_source::bind_calibration(const sensor& a_sensor, const sensor_table& a_sensor_table)
+{
+    if (a_sensor.get_calibration().empty()) {
+        return;
+    }
+    int t_sensor_number = a_sensor.get_number();
+    calibration_index t_index(calibration(a_sensor, a_sensor_table));
+    if (a_sensor.has_calibration_versions()) {
+        for (const auto& t_version: a_sensor.get_versions()) {
+            if (t_version.f_calibration.empty()) {
+                hERROR(cerr << "no calibration for a period: " << a_sensor.get_name().join(".") << ": ignored" << endl);
+                continue;
+            }
+            sensor t_version_sensor = a_sensor;
+            t_version_sensor.set_calibration(t_version.f_calibration);
+            calibration t_calib(t_version_sensor, a_sensor_table);
+            if (t_calib.get_input_sensor() != t_index.get_input_sensor()) {
+                hERROR(cerr << "calibration input changes over time: " << a_sensor.get_name().join(".") << ": ignored" << endl);
+                continue;
+            }
+            if (! t_index.add(t_version.f_start, t_version.f_stop, t_calib)) {
+                hERROR(cerr << "overlapping calibration periods: " << a_sensor.get_name().join(".") << ": ignored" << endl);
+            }
+        }
+    }
+    f_calibration_table[t_sensor_number] = t_index;
+    hINFO(cerr
+          << "    " << a_sensor.get_name().join(".") << " <= "
+          << a_sensor_table[f_calibration_table[t_sensor_number].get_input_sensor()].get_name().join(".") << " : "
+          << f_calibration_table[t_sensor_number].get_description() << endl
+    );
+}
+
 vector<series> data_source::read(const vector<int>& a_sensor_list, double a_from, double a_to, double a_resampling_interval, const std::string& a_reducer)
 {
+    this->resolve(a_sensor_list);
+    
     vector<int> t_input_sensor_list;
     for (unsigned i = 0; i < a_sensor_list.size(); i++) {
         t_input_sensor_list.emplace_back(find_input(a_sensor_list[i]));
     }
 
-    vector<series> t_series_list = this->fetch(t_input_sensor_list, a_from, a_to, a_resampling_interval, a_reducer);
+    // values reduced before a (possibly non-linear) calibration differ from the calibrated values reduced,
+    // except for picking a point, and for the mean (and the min and max, if increasing) with a linear
+    // calibration; the other calibrated sensors are fetched without the resampling hint //
+    vector<series> t_series_list;
+    bool t_is_picking = (a_reducer == "first") || (a_reducer == "last");
+    vector<unsigned> t_hinted, t_unhinted;
+    for (unsigned i = 0; i < a_sensor_list.size(); i++) {
+        bool t_is_calibrated = (t_input_sensor_list[i] != a_sensor_list[i]);
+        bool t_is_reducible = ! t_is_calibrated || t_is_picking;
+        if ((a_resampling_interval > 0) && ! t_is_reducible) {
+            if (a_reducer == "mean") {
+                t_is_reducible = (find_linearity(a_sensor_list[i]) != 0);
+            }
+            else if ((a_reducer == "min") || (a_reducer == "max")) {
+                t_is_reducible = (find_linearity(a_sensor_list[i]) > 0);
+            }
+        }
+        if ((a_resampling_interval > 0) && ! t_is_reducible) {
+            t_unhinted.push_back(i);
+        }
+        else {
+            t_hinted.push_back(i);
+        }
+    }
+    if (t_unhinted.empty()) {
+        t_series_list = this->fetch(t_input_sensor_list, a_from, a_to, a_resampling_interval, a_reducer);
+    }
+    else if (t_hinted.empty()) {
+        t_series_list = this->fetch(t_input_sensor_list, a_from, a_to, -1, "");
+    }
+    else {
+        vector<int> t_hinted_inputs, t_unhinted_inputs;
+        for (unsigned i: t_hinted) {
+            t_hinted_inputs.push_back(t_input_sensor_list[i]);
+        }
+        for (unsigned i: t_unhinted) {
+            t_unhinted_inputs.push_back(t_input_sensor_list[i]);
+        }
+        vector<series> t_hinted_series = this->fetch(t_hinted_inputs, a_from, a_to, a_resampling_interval, a_reducer);
+        vector<series> t_unhinted_series = this->fetch(t_unhinted_inputs, a_from, a_to, -1, "");
+        t_series_list.resize(a_sensor_list.size(), series(a_from, a_to));
+        for (unsigned k = 0; k < t_hinted.size(); k++) {
+            t_series_list[t_hinted[k]] = std::move(t_hinted_series[k]);
+        }
+        for (unsigned k = 0; k < t_unhinted.size(); k++) {
+            t_series_list[t_unhinted[k]] = std::move(t_unhinted_series[k]);
+        }
+    }
     
+    metrics_span t_span(pipeline_metrics::e_stage_calibrate);
     for (unsigned i = 0; i < a_sensor_list.size(); i++) {
         apply_calibration(a_sensor_list[i], t_series_list[i]);
     }
+    metrics_scope::add_count(pipeline_metrics::e_counter_sensors, a_sensor_list.size());
 
     return t_series_list;
 }
 
 int data_source::find_input(int a_sensor)
 {
-    auto iter = f_calibration_table.find(a_sensor);
-    if (iter == f_calibration_table.end()) {
-        return a_sensor;
+    std::lock_guard<std::mutex> t_lock(f_binding_mutex);
+    for (auto iter = f_calibration_table.find(a_sensor); iter != f_calibration_table.end(); ) {
+        a_sensor = iter->second.get_input_sensor();
+        iter = f_calibration_table.find(a_sensor);
     }
-    
-    const auto& t_calib = iter->second;
-    return this->find_input(t_calib.get_input_sensor());
+
+    return a_sensor;
+}
+
+int data_source::find_linearity(int a_sensor)
+{
+    int t_linearity = +1;
+    std::lock_guard<std::mutex> t_lock(f_binding_mutex);
+    for (auto iter = f_calibration_table.find(a_sensor); iter != f_calibration_table.end(); ) {
+        t_linearity *= iter->second.get_linearity();
+        iter = f_calibration_table.find(iter->second.get_input_sensor());
+    }
+
+    return t_linearity;
 }
 
 void data_source::apply_calibration(int a_sensor, series& a_series)
 {
-    auto iter = f_calibration_table.find(a_sensor);
-    if (iter == f_calibration_table.end()) {
+    // calibration chain, in the order of application //
+    vector<const calibration_index*> t_chain; {
+        std::lock_guard<std::mutex> t_lock(f_binding_mutex);
+        for (auto iter = f_calibration_table.find(a_sensor); iter != f_calibration_table.end(); ) {
+            t_chain.insert(t_chain.begin(), &iter->second);
+            iter = f_calibration_table.find(iter->second.get_input_sensor());
+        }
+    }
+    if (t_chain.empty()) {
         return;
     }
-    const auto& t_calib = iter->second;
-    
-    this->apply_calibration(t_calib.get_input_sensor(), a_series);
+
+    const auto& t = a_series.t();
+    auto& x = a_series.x();
     
-    for (auto& xk: a_series.x()) {
-        xk = t_calib(xk);
+    // large series are split into chunks, each calibrated in a thread with its own evaluator clones //
+    static const size_t t_min_chunk_size = 1 << 15;
+    unsigned t_number_of_threads = f_number_of_threads;
+    if (t_number_of_threads == 0) {
+        t_number_of_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    t_number_of_threads = std::min<size_t>(t_number_of_threads, x.size() / t_min_chunk_size);
+
+    if (t_number_of_threads <= 1) {
+        // the evaluation state (evaluator variables, memo) is shared by concurrent reads //
+        std::lock_guard<std::mutex> t_lock(f_calibration_mutex);
+        for (const auto* t_calib: t_chain) {
+            t_calib->apply(t, x, 0, x.size());
+        }
     }
+    else {
+        size_t t_chunk_size = (x.size() + t_number_of_threads - 1) / t_number_of_threads;
+        vector<std::thread> t_threads;
+        vector<std::exception_ptr> t_errors(t_number_of_threads);
+        for (unsigned i = 0; i < t_number_of_threads; i++) {
+            vector<calibration_index> t_local_chain;
+            for (const auto* t_calib: t_chain) {
+                t_local_chain.push_back(t_calib->clone());
+            }
+            size_t t_begin = i * t_chunk_size, t_end = std::min(x.size(), t_begin + t_chunk_size);
+            t_threads.emplace_back([&t, &x, &t_errors, i, t_begin, t_end, t_local_chain=std::move(t_local_chain)]() {
+                try {
+                    for (const auto& t_calib: t_local_chain) {
+                        t_calib.apply(t, x, t_begin, t_end);
+                    }
+                }
+                catch (...) {
+                    t_errors[i] = std::current_exception();
+                }
+            });
+        }
+        for (auto& t_thread: t_threads) {
+            t_thread.join();
+        }
+        for (auto& t_error: t_errors) {
+            if (t_error) {
+                std::rethrow_exception(t_error);
+            }
+        }
+    }
+    
     hINFO(cerr << "Calibration: " << endl);
-    hINFO(cerr << "    " << t_calib.get_description() << endl);
+    for (const auto* t_calib: t_chain) {
+        hINFO(cerr << "    " << t_calib->get_description() << endl);
+    }
 }
 
 vector<series> data_source::fetch(const vector<int>& a_sensor_list, double a_from, double a_to, double a_resampling_interval, const std::string& a_reducer)
@@ -114,13 +316,21 @@ vector<series> data_source::fetch(const vector<int>& a_sensor_list, double a_fro
 
 
 
-dripline_pgsql::dripline_pgsql(string a_uri, name_chain a_basename, const string& a_input_delimiters, const string& a_output_delimiter)
+dripline_pgsql::dripline_pgsql(string a_uri, name_chain a_basename, const string& a_input_delimiters, const string& a_output_delimiter, const metadata* a_metadata)
 : f_db_uri(a_uri), f_basename(a_basename.get_chain()), f_input_delimiters(a_input_delimiters), f_output_delimiter(a_output_delimiter)
 {
-    f_pgsql.set_db(f_db_uri);
+    f_pgsql = make_shared<pgsql>(f_db_uri);
+
+    if (a_metadata) {
+        f_has_idmap = a_metadata->f_has_idmap;
+        f_sensorname_column = a_metadata->f_sensorname_column;
+        f_data_names = a_metadata->f_data_names;
+        f_stamp = a_metadata->f_stamp;
+        return;
+    }
 
     f_has_idmap = false; {
-        vector<string> t_tables = f_pgsql.get_table_list();
+        vector<string> t_tables = f_pgsql->get_table_list();
         for (auto& t: t_tables) {
             if (t == "endpoint_id_map") {
                 hINFO(cerr << "Found Dripline ID-Map" << endl);
@@ -131,7 +341,7 @@ dripline_pgsql::dripline_pgsql(string a_uri, name_chain a_basename, const string
     }
 
     f_sensorname_column = ""; {
-        vector<string> t_fields = f_pgsql.get_column_list("numeric_data");
+        vector<string> t_fields = f_pgsql->get_column_list("numeric_data");
         for (auto& f: t_fields) {
             if ((f == "endpoint_name") || (f == "sensor_name")) {
                 f_sensorname_column = f;
@@ -152,17 +362,57 @@ vector<string> dripline_pgsql::get_data_names()
     }
         
     hINFO(cerr << "getting Dripline end-point names..." << endl);
+    f_stamp = this->query_metadata_stamp();
     string t_sql = "select distinct " + f_sensorname_column;
     t_sql += (f_has_idmap ? " from endpoint_id_map" : " from numeric_data");
     auto t_handler = [&](int a_row, int a_col, const char* a_value) {
         f_data_names.emplace_back(a_value);
     };
-    f_pgsql.query(t_sql, t_handler);
+    f_pgsql->query(t_sql, t_handler);
     hINFO(cerr << "    " << f_data_names.size() << " end-points found." << endl);
 
     return f_data_names;
 }
 
+dripline_pgsql::metadata dripline_pgsql::get_metadata()
+{
+    metadata t_metadata;
+    t_metadata.f_has_idmap = f_has_idmap;
+    t_metadata.f_sensorname_column = f_sensorname_column;
+    t_metadata.f_data_names = this->get_data_names();
+    t_metadata.f_stamp = f_stamp;
+
+    return t_metadata;
+}
+
+string dripline_pgsql::query_metadata_stamp()
+{
+    // without the ID-map, new end-points can be found only by a full scan of the data table //
+    if (! f_has_idmap) {
+        return "";
+    }
+    
+    string t_stamp;
+    auto t_handler = [&](int a_row, int a_col, const char* a_value) {
+        t_stamp = a_value;
+    };
+    f_pgsql->query("select count(*) from endpoint_id_map", t_handler);
+
+    return t_stamp;
+}
+
+bool dripline_pgsql::revalidate_metadata()
+{
+    string t_stamp = this->query_metadata_stamp();
+    if (! t_stamp.empty() && (t_stamp == f_stamp)) {
+        return true;
+    }
+    f_data_names.clear();
+    f_stamp.clear();
+
+    return false;
+}
+
 void dripline_pgsql::bind_inputs(sensor_table& a_sensor_table)
 {
     // 1: get data names
@@ -177,19 +427,81 @@ void dripline_pgsql::bind_inputs(sensor_table& a_sensor_table)
     if (! f_input_delimiters.empty()) {
         t_config.set_delimiters(f_input_delimiters, f_output_delimiter);
     }
+    t_config.set_data_source(f_source_name);
     t_config.load(a_sensor_table, t_dripline_names, f_basename);
 
-    // 3: make a Dripline endpoint table
+    // 3: make a Dripline endpoint table //
+    // the binding can change over time, following the sensor versions; the current one fills the gaps //
     hINFO(cerr << "Dripline Endpoint Binding: " << endl);
     set<string> t_endpoint_list(t_dripline_names.begin(), t_dripline_names.end());
     for (int t_number: a_sensor_table.find_like({{}})) {
         const sensor& t_sensor = a_sensor_table[t_number];
-        string t_endpoint = t_sensor.get_option("dripline_endpoint", "");
-        if (t_endpoint_list.count(t_endpoint) > 0) {
-            f_endpoint_table[t_number] = t_endpoint;
-            hINFO(cerr << "    " << t_endpoint << " => " << t_sensor.get_name().join(f_output_delimiter) << endl);
+        if (is_assigned_elsewhere(t_sensor)) {
+            continue;
+        }
+        vector<endpoint_binding> t_bindings = make_bindings(t_sensor, &t_endpoint_list);
+        if (t_bindings.empty()) {
+            continue;
+        }
+        
+        for (const auto& t_binding: t_bindings) {
+            string t_period;
+            if (t_bindings.size() > 1) {
+                t_period += " (" + (std::isinf(t_binding.f_start) ? string("") : datetime(t_binding.f_start).as_string());
+                t_period += " - " + (std::isinf(t_binding.f_stop) ? string("") : datetime(t_binding.f_stop).as_string()) + ")";
+            }
+            hINFO(cerr << "    " << t_binding.f_endpoint << " => " << t_sensor.get_name().join(f_output_delimiter) << t_period << endl);
+        }
+        f_endpoint_table[t_number] = std::move(t_bindings);
+    }
+}
+
+bool dripline_pgsql::bind_input(const sensor& a_sensor)
+{
+    // explicit bindings only; inference from the end-point names needs the full list //
+    vector<endpoint_binding> t_bindings = make_bindings(a_sensor, nullptr);
+    if (t_bindings.empty()) {
+        return false;
+    }
+    for (const auto& t_binding: t_bindings) {
+        hINFO(cerr << "Dripline Endpoint Binding: " << t_binding.f_endpoint << " => " << a_sensor.get_name().join(f_output_delimiter) << endl);
+    }
+    f_endpoint_table[a_sensor.get_number()] = std::move(t_bindings);
+
+    return true;
+}
+
+vector<dripline_pgsql::endpoint_binding> dripline_pgsql::make_bindings(const sensor& a_sensor, const set<string>* a_endpoint_list)
+{
+    // the binding can change over time, following the sensor versions; the current one fills the gaps //
+    // without a_endpoint_list, the end-points are not checked to exist //
+    const double t_inf = std::numeric_limits<double>::infinity();
+    string t_endpoint = a_sensor.get_option("dripline_endpoint", "");
+    vector<endpoint_binding> t_bindings;
+    auto append = [&](double a_start, double a_stop, const string& a_endpoint) {
+        if (! (a_start < a_stop) || a_endpoint.empty()) {
+            return;
+        }
+        if (a_endpoint_list && (a_endpoint_list->count(a_endpoint) == 0)) {
+            return;
+        }
+        if (! t_bindings.empty() && (t_bindings.back().f_stop == a_start) && (t_bindings.back().f_endpoint == a_endpoint)) {
+            t_bindings.back().f_stop = a_stop;
+        }
+        else {
+            t_bindings.push_back({a_start, a_stop, a_endpoint});
         }
+    };
+    double t_cursor = -t_inf;
+    for (const auto& t_version: a_sensor.get_versions()) {
+        append(t_cursor, t_version.f_start, t_endpoint);
+        auto iter = t_version.f_options.find("dripline_endpoint");
+        append(t_version.f_start, t_version.f_stop, (iter != t_version.f_options.end()) ? iter->second : t_endpoint);
+        t_cursor = std::max(t_cursor, t_version.f_stop);
     }
+    append(t_cursor, +t_inf, t_endpoint);
+
+    return t_bindings;
 }
 
 void dripline_pgsql::fetch_single(series& a_series, int a_sensor, double a_from, double a_to, double a_resampling_interval, const std::string& a_reducer)
@@ -209,22 +521,32 @@ vector<series> dripline_pgsql::fetch(const vector<int>& a_sensor_list, double a_
 {
     vector<series> t_series_list;
     
-    map<string, vector<unsigned>> t_series_index_table;
+    map<string, vector<target>> t_series_index_table;
     string t_targets;
+    std::unique_lock<std::mutex> t_lock(f_binding_mutex);
     for (auto t_sensor: a_sensor_list) {
         auto iter = f_endpoint_table.find(t_sensor);
         if (iter != f_endpoint_table.end()) {
-            if (t_series_index_table.count(iter->second) == 0) {
-                t_targets += (t_targets.empty() ? "'" : ",'") + iter->second + "'";
+            for (const auto& t_binding: iter->second) {
+                if ((t_binding.f_stop <= a_from) || (t_binding.f_start >= a_to)) {
+                    continue;
+                }
+                if (t_series_index_table.count(t_binding.f_endpoint) == 0) {
+                    t_targets += (t_targets.empty() ? "'" : ",'") + t_binding.f_endpoint + "'";
+                }
+                t_series_index_table[t_binding.f_endpoint].push_back({(unsigned) t_series_list.size(), t_binding.f_start, t_binding.f_stop});
             }
-            t_series_index_table[iter->second].push_back(t_series_list.size());
         }
         t_series_list.emplace_back(a_from, a_to);
     }
+    t_lock.unlock();
 
     if (t_targets.empty()) {
         return t_series_list;
     }
+    if ((a_resampling_interval > 0) && this->fetch_rollup(t_series_list, t_series_index_table, t_targets, a_from, a_to, a_resampling_interval, a_reducer)) {
+        return t_series_list;
+    }
     
     string t_sql; {
         string date_from = datetime(a_from).as_string() + "Z";
@@ -362,7 +684,7 @@ vector<series> dripline_pgsql::fetch(const vector<int>& a_sensor_list, double a_
     hINFO(cerr << "    " << t_sql << endl);
 
     double time;
-    map<string, vector<unsigned>>::iterator t_channel_iter;
+    map<string, vector<target>>::iterator t_channel_iter;
     auto t_handler = [&](int a_row, int a_col, const char* a_value) {
         if (a_col == 0) {
             time = stod(a_value);
@@ -371,12 +693,15 @@ vector<series> dripline_pgsql::fetch(const vector<int>& a_sensor_list, double a_
             t_channel_iter = t_series_index_table.find(a_value);
         }
         else {
-            for (unsigned index: t_channel_iter->second) {
-                t_series_list[index].emplace_back(time, stod(a_value));
+            double t_value = stod(a_value);
+            for (const auto& t_target: t_channel_iter->second) {
+                if ((time >= t_target.f_start) && (time < t_target.f_stop)) {
+                    t_series_list[t_target.f_index].emplace_back(time, t_value);
+                }
             }
         }
     };
-    if (f_pgsql.query(t_sql, t_handler) < 0) {
+    if (f_pgsql->query(t_sql, t_handler) < 0) {
         throw std::runtime_error("DB Query Error: SQL: " + t_sql);
     }
 
@@ -385,11 +710,1261 @@ vector<series> dripline_pgsql::fetch(const vector<int>& a_sensor_list, double a_
 
 
 
-vector<string> csv_file::get_data_names()
+bool dripline_pgsql::fetch_rollup(vector<series>& a_series_list, const map<string, vector<target>>& a_series_index_table, const string& a_targets, double a_from, double a_to, double a_resampling_interval, const std::string& a_reducer)
+{
+    // partial aggregates can be combined only for these; the others are reduced from the raw data //
+    static const set<string> t_reducer_list = { "mean", "min", "max", "first", "last" };
+    if (t_reducer_list.count(a_reducer) == 0) {
+        return false;
+    }
+
+    dripline_rollup t_rollup(f_pgsql, f_sensorname_column);
+    int t_availability; {
+        std::lock_guard<std::mutex> t_lock(f_binding_mutex);
+        t_availability = f_rollup_availability;
+    }
+    if (t_availability < 0) {
+        t_availability = t_rollup.is_available() ? 1 : 0;
+        hINFO(cerr << "Dripline Rollup Tables: " << (t_availability ? "found" : "not found") << endl);
+        std::lock_guard<std::mutex> t_lock(f_binding_mutex);
+        f_rollup_availability = t_availability;
+    }
+    if (t_availability == 0) {
+        return false;
+    }
+    
+    // groups of the client-side resampler (time_grouper), aligned to the end //
+    const double t_step = a_resampling_interval;
+    const double t_grid_start = a_to - ceil((a_to - a_from) / t_step) * t_step;
+
+    // the coarsest resolution dividing the interval, with buckets aligned to the groups; a bucket across
+    // a group boundary would mix the data of two groups, so the raw data is used if none is aligned //
+    unsigned t_resolution = 0;
+    double t_lo = 0, t_hi = 0;
+    for (const auto& t_coverage: t_rollup.get_coverage()) {
+        double R = t_coverage.f_resolution;
+        if ((R > t_step) || (fmod(t_step, R) != 0) || (fmod(t_grid_start, R) != 0)) {
+            continue;
+        }
+        double t_this_lo = std::max(ceil(a_from / R) * R, t_coverage.f_since);
+        double t_this_hi = std::min(floor(a_to / R) * R, t_coverage.f_until);
+        if (t_this_hi <= t_this_lo) {
+            continue;
+        }
+        if (t_coverage.f_resolution > t_resolution) {
+            t_resolution = t_coverage.f_resolution;
+            t_lo = t_this_lo;
+            t_hi = t_this_hi;
+        }
+    }
+    if (t_resolution == 0) {
+        return false;
+    }
+    // buckets are not split at the changes of the endpoint binding //
+    for (const auto& t_entry: a_series_index_table) {
+        for (const auto& t_target: t_entry.second) {
+            if (((t_target.f_start > t_lo) && (t_target.f_start < t_hi)) || ((t_target.f_stop > t_lo) && (t_target.f_stop < t_hi))) {
+                return false;
+            }
+        }
+    }
+    hINFO(cerr << "Dripline Rollup: " << t_resolution << "s for " << datetime((long) t_lo).as_string() << " - " << datetime((long) t_hi).as_string() << endl);
+    
+    struct accumulator {
+        double f_count = 0, f_sum = 0;
+        double f_min = std::numeric_limits<double>::infinity(), f_max = -std::numeric_limits<double>::infinity();
+        double f_first = std::numeric_limits<double>::quiet_NaN(), f_last = std::numeric_limits<double>::quiet_NaN();
+        double f_first_time = std::numeric_limits<double>::infinity(), f_last_time = -std::numeric_limits<double>::infinity();
+    };
+    vector<map<long, accumulator>> t_group_table(a_series_list.size());
+    auto t_accumulate = [&](const char* a_endpoint, double a_time, double a_group_time, const dripline_rollup::bucket& a_bucket) {
+        auto iter = a_series_index_table.find(a_endpoint);
+        if (iter == a_series_index_table.end()) {
+            return;
+        }
+        for (const auto& t_target: iter->second) {
+            if ((a_time < t_target.f_start) || (a_time >= t_target.f_stop)) {
+                continue;
+            }
+            accumulator& t_group = t_group_table[t_target.f_index][(long) floor((a_group_time - t_grid_start) / t_step)];
+            t_group.f_count += a_bucket.f_count;
+            t_group.f_sum += a_bucket.f_sum;
+            t_group.f_min = std::min(t_group.f_min, a_bucket.f_min);
+            t_group.f_max = std::max(t_group.f_max, a_bucket.f_max);
+            if (a_time < t_group.f_first_time) {
+                t_group.f_first_time = a_time;
+                t_group.f_first = a_bucket.f_first;
+            }
+            if (a_time > t_group.f_last_time) {
+                t_group.f_last_time = a_time;
+                t_group.f_last = a_bucket.f_last;
+            }
+        }
+    };
+
+    // rolled-up buckets, each in one group //
+    auto t_bucket_handler = [&](const dripline_rollup::bucket& a_bucket) {
+        t_accumulate(a_bucket.f_endpoint, a_bucket.f_time, a_bucket.f_time + 0.5 * t_resolution, a_bucket);
+    };
+    t_rollup.read(t_resolution, a_targets, t_lo, t_hi, t_bucket_handler);
+    
+    // raw data outside the rollup range //
+    if ((a_from < t_lo) || (t_hi < a_to)) {
+        string t_sql = (string("")
+            + "SELECT"
+            + "  extract(epoch from timestamp), " + f_sensorname_column + ", value_raw "
+            + "FROM"
+            + "  numeric_data "
+            + "WHERE "
+            + "  " + f_sensorname_column + " IN (" + a_targets + ") "
+            + "  AND ("
+            + "    (timestamp>='" + datetime(a_from).as_string() + "Z' AND timestamp<'" + datetime(t_lo).as_string() + "Z') OR "
+            + "    (timestamp>='" + datetime(t_hi).as_string() + "Z' AND timestamp<'" + datetime(a_to).as_string() + "Z')"
+            + "  )"
+        );
+        hINFO(cerr << "SQL: " << endl);
+        hINFO(cerr << "    " << t_sql << endl);
+        
+        double t_time = 0;
+        string t_endpoint;
+        dripline_rollup::bucket t_point;
+        auto t_handler = [&](int a_row, int a_col, const char* a_value) {
+            if (a_col == 0) {
+                t_time = stod(a_value);
+            }
+            else if (a_col == 1) {
+                t_endpoint = a_value;
+            }
+            else if (*a_value) {
+                double x = stod(a_value);
+                if (! std::isnan(x)) {
+                    t_point = { t_time, nullptr, 1, x, x*x, x, x, x, x };
+                    t_accumulate(t_endpoint.c_str(), t_time, t_time, t_point);
+                }
+            }
+        };
+        if (f_pgsql->query(t_sql, t_handler) < 0) {
+            throw std::runtime_error("DB Query Error: SQL: " + t_sql);
+        }
+    }
+
+    // one point per group, at the center as the resampler places them //
+    for (unsigned i = 0; i < a_series_list.size(); i++) {
+        for (const auto& t_entry: t_group_table[i]) {
+            const accumulator& t_group = t_entry.second;
+            double x;
+            if (a_reducer == "mean") {
+                x = t_group.f_sum / t_group.f_count;
+            }
+            else if (a_reducer == "min") {
+                x = t_group.f_min;
+            }
+            else if (a_reducer == "max") {
+                x = t_group.f_max;
+            }
+            else if (a_reducer == "first") {
+                x = t_group.f_first;
+            }
+            else {
+                x = t_group.f_last;
+            }
+            a_series_list[i].emplace_back(t_grid_start + (t_entry.first + 0.5) * t_step, x);
+        }
+    }
+    
+    return true;
+}
+
+
+
+namespace {
+    // parsers of the CSV fields, without allocations or locale; quotes, blanks and CR around the fields are skipped //
+    
+    const double g_exact_powers_of_ten[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    inline void trim_field(const char*& a_begin, const char*& a_end)
+    {
+        while ((a_begin < a_end) && ((*a_begin == ' ') || (*a_begin == '\t') || (*a_begin == '"'))) {
+            a_begin++;
+        }
+        while ((a_end > a_begin) && ((a_end[-1] == ' ') || (a_end[-1] == '\t') || (a_end[-1] == '"') || (a_end[-1] == '\r'))) {
+            a_end--;
+        }
+    }
+
+    double parse_number_slow(const char* a_begin, const char* a_end)
+    {
+        char t_buffer[64];
+        size_t t_length = std::min<size_t>(a_end - a_begin, sizeof(t_buffer) - 1);
+        memcpy(t_buffer, a_begin, t_length);
+        t_buffer[t_length] = '\0';
+        char* t_stop;
+        double t_value = strtod(t_buffer, &t_stop);
+        if ((t_stop == t_buffer) || (*t_stop != '\0')) {
+            return std::numeric_limits<double>::quiet_NaN();  // empty, null, None, ...
+        }
+        return t_value;
+    }
+    
+    // exact for up to 15 significant digits (Clinger's fast path), which covers the usual output; strtod() otherwise //
+    double parse_number(const char* a_begin, const char* a_end)
+    {
+        trim_field(a_begin, a_end);
+        const char* p = a_begin;
+        bool t_is_negative = false;
+        if ((p < a_end) && ((*p == '-') || (*p == '+'))) {
+            t_is_negative = (*p == '-');
+            p++;
+        }
+        uint64_t t_mantissa = 0;
+        int t_exponent = 0, t_number_of_digits = 0;
+        for (; (p < a_end) && (*p >= '0') && (*p <= '9'); p++, t_number_of_digits++) {
+            if (t_mantissa > (1ull << 53) / 10) {
+                return parse_number_slow(a_begin, a_end);
+            }
+            t_mantissa = 10 * t_mantissa + (*p - '0');
+        }
+        if ((p < a_end) && (*p == '.')) {
+            for (p++; (p < a_end) && (*p >= '0') && (*p <= '9'); p++, t_number_of_digits++) {
+                if (t_mantissa > (1ull << 53) / 10) {
+                    return parse_number_slow(a_begin, a_end);
+                }
+                t_mantissa = 10 * t_mantissa + (*p - '0');
+                t_exponent--;
+            }
+        }
+        if (t_number_of_digits == 0) {
+            return parse_number_slow(a_begin, a_end);  // nan, inf, or not a number
+        }
+        if ((p < a_end) && ((*p == 'e') || (*p == 'E'))) {
+            p++;
+            bool t_is_exponent_negative = false;
+            if ((p < a_end) && ((*p == '-') || (*p == '+'))) {
+                t_is_exponent_negative = (*p == '-');
+                p++;
+            }
+            int t_value = 0;
+            const char* t_exponent_begin = p;
+            for (; (p < a_end) && (*p >= '0') && (*p <= '9') && (t_value < 10000); p++) {
+                t_value = 10 * t_value + (*p - '0');
+            }
+            if (p == t_exponent_begin) {
+                return parse_number_slow(a_begin, a_end);
+            }
+            t_exponent += (t_is_exponent_negative ? -t_value : t_value);
+        }
+        if ((p != a_end) || (t_exponent < -22) || (t_exponent > 22)) {
+            return parse_number_slow(a_begin, a_end);
+        }
+        
+        double t_value = t_mantissa;
+        if (t_exponent < 0) {
+            t_value /= g_exact_powers_of_ten[-t_exponent];
+        }
+        else {
+            t_value *= g_exact_powers_of_ten[t_exponent];
+        }
+        return t_is_negative ? -t_value : t_value;
+    }
+
+    inline bool parse_digits(const char* p, int a_length, int& a_value)
+    {
+        a_value = 0;
+        for (int i = 0; i < a_length; i++) {
+            if ((p[i] < '0') || (p[i] > '9')) {
+                return false;
+            }
+            a_value = 10 * a_value + (p[i] - '0');
+        }
+        return true;
+    }
+
+    int64_t days_from_civil(int64_t y, unsigned m, unsigned d)
+    {
+        // days since 1970-01-01 in the proleptic Gregorian calendar //
+        y -= (m <= 2);
+        int64_t t_era = (y >= 0 ? y : y - 399) / 400;
+        unsigned t_year_of_era = (unsigned) (y - t_era * 400);
+        unsigned t_day_of_year = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+        unsigned t_day_of_era = t_year_of_era * 365 + t_year_of_era / 4 - t_year_of_era / 100 + t_day_of_year;
+        return t_era * 146097 + (int64_t) t_day_of_era - 719468;
+    }
+    
+    // UNIX time, or ISO 8601 "YYYY-MM-DD[T ]hh:mm:ss[.ffffff][Z|+hh:mm]" (UTC if the zone is not given) //
+    double parse_time(const char* a_begin, const char* a_end)
+    {
+        trim_field(a_begin, a_end);
+        const char* p = a_begin;
+        if ((a_end - p < 10) || (p[4] != '-') || (p[7] != '-')) {
+            return parse_number(a_begin, a_end);
+        }
+
+        const double t_nan = std::numeric_limits<double>::quiet_NaN();
+        int t_year, t_month, t_day, t_hour = 0, t_min = 0, t_sec = 0;
+        if (! parse_digits(p, 4, t_year) || ! parse_digits(p+5, 2, t_month) || ! parse_digits(p+8, 2, t_day)) {
+            return t_nan;
+        }
+        if ((t_month < 1) || (t_month > 12) || (t_day < 1) || (t_day > 31)) {
+            return t_nan;
+        }
+        p += 10;
+        if ((p < a_end) && ((*p == 'T') || (*p == ' '))) {
+            if ((a_end - p < 9) || (p[3] != ':') || (p[6] != ':')) {
+                return t_nan;
+            }
+            if (! parse_digits(p+1, 2, t_hour) || ! parse_digits(p+4, 2, t_min) || ! parse_digits(p+7, 2, t_sec)) {
+                return t_nan;
+            }
+            p += 9;
+        }
+        int64_t t_fraction = 0, t_scale = 1;
+        if ((p < a_end) && (*p == '.')) {
+            for (p++; (p < a_end) && (*p >= '0') && (*p <= '9'); p++) {
+                if (t_scale < 1000000000) {
+                    t_fraction = 10 * t_fraction + (*p - '0');
+                    t_scale *= 10;
+                }
+            }
+        }
+        int t_offset = 0;
+        if ((p < a_end) && (*p == 'Z')) {
+            p++;
+        }
+        else if ((p < a_end) && ((*p == '+') || (*p == '-'))) {
+            int t_sign = (*p == '+') ? 1 : -1, t_zone_hour, t_zone_min = 0;
+            p++;
+            if ((a_end - p < 2) || ! parse_digits(p, 2, t_zone_hour)) {
+                return t_nan;
+            }
+            p += 2;
+            if ((p < a_end) && (*p == ':')) {
+                p++;
+            }
+            if (a_end - p >= 2) {
+                if (! parse_digits(p, 2, t_zone_min)) {
+                    return t_nan;
+                }
+                p += 2;
+            }
+            t_offset = t_sign * (3600 * t_zone_hour + 60 * t_zone_min);
+        }
+        if (p != a_end) {
+            return t_nan;
+        }
+
+        // integer arithmetic up to the final division, so that microseconds are exact as in the database //
+        int64_t t_seconds = 86400 * days_from_civil(t_year, t_month, t_day) + 3600 * t_hour + 60 * t_min + t_sec - t_offset;
+        if (t_scale == 1) {
+            return t_seconds;
+        }
+        return (double) (t_seconds * t_scale + t_fraction) / t_scale;
+    }
+
+    // calls a_function(column, begin, end) for the fields of the line up to a_last_column //
+    template<class function_t>
+    void for_each_field(const char* a_begin, const char* a_end, int a_last_column, function_t a_function)
+    {
+        const char* p = a_begin;
+        for (int t_column = 0; t_column <= a_last_column; t_column++) {
+            const char* q = p;
+            if ((q < a_end) && (*q == '"')) {
+                const char* t_quote = (const char*) memchr(q + 1, '"', a_end - q - 1);
+                q = t_quote ? t_quote : a_end;
+            }
+            q = (const char*) memchr(q, ',', a_end - q);
+            if (! q) {
+                q = a_end;
+            }
+            a_function(t_column, p, q);
+            if (q == a_end) {
+                break;
+            }
+            p = q + 1;
+        }
+    }
+
+    inline const char* end_of_line(const char* a_begin, const char* a_end)
+    {
+        const char* t_end = (const char*) memchr(a_begin, '\n', a_end - a_begin);
+        return t_end ? t_end : a_end;
+    }
+
+    inline bool is_comment_or_blank(const char* a_begin, const char* a_end)
+    {
+        while ((a_begin < a_end) && ((*a_begin == ' ') || (*a_begin == '\t') || (*a_begin == '\r'))) {
+            a_begin++;
+        }
+        return (a_begin == a_end) || (*a_begin == '#');
+    }
+    
+    string to_lower(string a_text)
+    {
+        std::transform(a_text.begin(), a_text.end(), a_text.begin(), [](unsigned char c){ return std::tolower(c); });
+        return a_text;
+    }
+
+    const char g_csv_index_magic[8] = { 'H', 'B', 'C', 'S', 'V', 'I', 0, 1 };
+    const size_t g_csv_checkpoint_interval = 1 << 20;  // bytes between checkpoints
+    const size_t g_csv_min_chunk_size = 1 << 22;       // bytes per thread
+}
+
+
+
+csv_file::csv_file(const string& a_path, name_chain a_basename, const string& a_input_delimiters, const string& a_output_delimiter)
+: f_path(a_path), f_basename(a_basename.get_chain()), f_input_delimiters(a_input_delimiters), f_output_delimiter(a_output_delimiter)
 {
-    return vector<string>();
+    f_map = nullptr;
+    f_data = nullptr;
+    f_size = f_body_offset = 0;
+    f_mtime = 0;
+    f_time_column = f_name_column = f_value_column = -1;
+    f_is_sorted = false;
+
+    int t_fd = ::open(a_path.c_str(), O_RDONLY);
+    if (t_fd < 0) {
+        throw std::runtime_error("CSV: unable to open file: " + a_path);
+    }
+    struct stat t_stat;
+    if (fstat(t_fd, &t_stat) != 0) {
+        ::close(t_fd);
+        throw std::runtime_error("CSV: unable to read file status: " + a_path);
+    }
+    f_size = t_stat.st_size;
+    f_mtime = (int64_t) t_stat.st_mtim.tv_sec * 1000000000 + t_stat.st_mtim.tv_nsec;
+    if (f_size > 0) {
+        void* t_map = mmap(nullptr, f_size, PROT_READ, MAP_SHARED, t_fd, 0);
+        if (t_map == MAP_FAILED) {
+            ::close(t_fd);
+            throw std::runtime_error("CSV: unable to map file: " + a_path);
+        }
+        f_map = t_map;
+        f_data = (const char*) t_map;
+        madvise(f_map, f_size, MADV_SEQUENTIAL);
+    }
+    ::close(t_fd);
+
+    try {
+        parse_header();
+        if (! load_index()) {
+            build_index();
+            save_index();
+        }
+    }
+    catch (...) {
+        if (f_map) {
+            munmap(f_map, f_size);
+        }
+        throw;
+    }
+    hINFO(cerr << "CSV File: " << f_path << ": " << f_data_names.size() << " data names" << (f_is_sorted ? ", sorted in time" : "") << endl);
 }
 
-void csv_file::fetch_single(series& a_series, int a_sensor, double a_from, double a_to, double a_resampling_interval, const std::string& a_reducer)
+csv_file::~csv_file()
 {
+    if (f_map) {
+        munmap(f_map, f_size);
+    }
+}
+
+void csv_file::parse_header()
+{
+    // the first line that is not blank or a comment has the column names //
+    const char* t_end = f_data + f_size;
+    const char* p = f_data;
+    while (p < t_end) {
+        const char* t_eol = end_of_line(p, t_end);
+        if (! is_comment_or_blank(p, t_eol)) {
+            for_each_field(p, t_eol, std::numeric_limits<int>::max(), [&](int a_column, const char* a_begin, const char* a_end) {
+                trim_field(a_begin, a_end);
+                f_columns.emplace_back(a_begin, a_end);
+            });
+            f_body_offset = std::min<size_t>(t_eol + 1 - f_data, f_size);
+            break;
+        }
+        p = t_eol + 1;
+    }
+    if (f_columns.empty()) {
+        throw std::runtime_error("CSV: no header line: " + f_path);
+    }
+
+    auto find_column = [&](const vector<string>& a_candidates) {
+        for (const auto& t_candidate: a_candidates) {
+            for (unsigned i = 0; i < f_columns.size(); i++) {
+                if (to_lower(f_columns[i]) == t_candidate) {
+                    return (int) i;
+                }
+            }
+        }
+        return -1;
+    };
+    static const vector<string> t_time_columns = { "timestamp", "datetime", "time", "unixtime" };
+    f_time_column = find_column(t_time_columns);
+    f_name_column = find_column({ "endpoint_name", "sensor_name", "sensor", "name" });
+    if (f_time_column < 0) {
+        throw std::runtime_error("CSV: no time column (TimeStamp or DateTime): " + f_path);
+    }
+    
+    if (f_name_column >= 0) {
+        f_value_column = find_column({ "value_raw", "value", "value_cal" });
+        if (f_value_column < 0) {
+            throw std::runtime_error("CSV: no value column for the name column: " + f_path);
+        }
+    }
+    else {
+        // the other time representations (e.g., DateTime along TimeStamp) are not data //
+        set<string> t_time_column_set(t_time_columns.begin(), t_time_columns.end());
+        for (unsigned i = 0; i < f_columns.size(); i++) {
+            if (t_time_column_set.count(to_lower(f_columns[i])) == 0) {
+                f_data_names.push_back(f_columns[i]);
+                f_data_columns.push_back(i);
+            }
+        }
+    }
+}
+
+vector<size_t> csv_file::split(size_t a_begin, size_t a_end) const
+{
+    // chunk boundaries are at line starts; a_begin and a_end must be line starts (or the file end) //
+    unsigned t_number_of_threads = f_number_of_threads;
+    if (t_number_of_threads == 0) {
+        t_number_of_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    t_number_of_threads = std::max<size_t>(1, std::min<size_t>(t_number_of_threads, (a_end - a_begin) / g_csv_min_chunk_size));
+
+    vector<size_t> t_boundaries = { a_begin };
+    size_t t_chunk_size = (a_end - a_begin) / t_number_of_threads;
+    for (unsigned i = 1; i < t_number_of_threads; i++) {
+        size_t t_offset = std::max(t_boundaries.back(), a_begin + i * t_chunk_size);
+        if (t_offset >= a_end) {
+            break;
+        }
+        t_offset = end_of_line(f_data + t_offset, f_data + a_end) - f_data;
+        t_offset = std::min(t_offset + 1, a_end);
+        if (t_offset > t_boundaries.back()) {
+            t_boundaries.push_back(t_offset);
+        }
+    }
+    if (t_boundaries.back() < a_end) {
+        t_boundaries.push_back(a_end);
+    }
+
+    return t_boundaries;
+}
+
+namespace {
+    template<class function_t>
+    void run_chunks(const vector<size_t>& a_boundaries, function_t a_function)
+    {
+        // a_function(chunk_index, begin, end), one thread per chunk //
+        size_t t_number_of_chunks = (a_boundaries.size() > 1) ? a_boundaries.size() - 1 : 0;
+        if (t_number_of_chunks == 1) {
+            a_function(0, a_boundaries[0], a_boundaries[1]);
+            return;
+        }
+        vector<std::thread> t_threads;
+        vector<std::exception_ptr> t_errors(t_number_of_chunks);
+        for (size_t i = 0; i < t_number_of_chunks; i++) {
+            t_threads.emplace_back([&, i]() {
+                try {
+                    a_function(i, a_boundaries[i], a_boundaries[i+1]);
+                }
+                catch (...) {
+                    t_errors[i] = std::current_exception();
+                }
+            });
+        }
+        for (auto& t_thread: t_threads) {
+            t_thread.join();
+        }
+        for (auto& t_error: t_errors) {
+            if (t_error) {
+                std::rethrow_exception(t_error);
+            }
+        }
+    }
+}
+
+void csv_file::build_index()
+{
+    struct chunk_scan {
+        bool f_is_sorted = true;
+        double f_first = std::numeric_limits<double>::quiet_NaN(), f_last = f_first;
+        vector<string> f_names;  // in order of appearance
+        vector<checkpoint> f_checkpoints;
+    };
+    
+    vector<size_t> t_boundaries = split(f_body_offset, f_size);
+    vector<chunk_scan> t_scans(t_boundaries.size() > 1 ? t_boundaries.size() - 1 : 0);
+    int t_last_column = std::max(f_time_column, f_name_column);
+    
+    run_chunks(t_boundaries, [&](size_t a_index, size_t a_begin, size_t a_end) {
+        chunk_scan& t_scan = t_scans[a_index];
+        set<string> t_name_set;
+        string t_name;
+        size_t t_next_checkpoint = a_begin;
+        const char* t_end = f_data + a_end;
+        for (const char* p = f_data + a_begin; p < t_end; ) {
+            const char* t_eol = end_of_line(p, t_end);
+            double t_time = std::numeric_limits<double>::quiet_NaN();
+            t_name.clear();
+            for_each_field(p, t_eol, t_last_column, [&](int a_column, const char* a_field_begin, const char* a_field_end) {
+                if (a_column == f_time_column) {
+                    t_time = parse_time(a_field_begin, a_field_end);
+                }
+                else if (a_column == f_name_column) {
+                    trim_field(a_field_begin, a_field_end);
+                    t_name.assign(a_field_begin, a_field_end);
+                }
+            });
+            if (! std::isnan(t_time)) {
+                if (t_time < t_scan.f_last) {
+                    t_scan.f_is_sorted = false;
+                }
+                if (std::isnan(t_scan.f_first)) {
+                    t_scan.f_first = t_time;
+                }
+                t_scan.f_last = t_time;
+                if ((size_t) (p - f_data) >= t_next_checkpoint) {
+                    t_scan.f_checkpoints.push_back({(uint64_t) (p - f_data), t_time});
+                    t_next_checkpoint = (p - f_data) + g_csv_checkpoint_interval;
+                }
+                if ((f_name_column >= 0) && ! t_name.empty() && t_name_set.insert(t_name).second) {
+                    t_scan.f_names.push_back(t_name);
+                }
+            }
+            p = t_eol + 1;
+        }
+    });
+
+    f_is_sorted = true;
+    f_checkpoints.clear();
+    set<string> t_name_set(f_data_names.begin(), f_data_names.end());
+    double t_last = std::numeric_limits<double>::quiet_NaN();
+    for (const auto& t_scan: t_scans) {
+        if (! t_scan.f_is_sorted || (t_scan.f_first < t_last)) {
+            f_is_sorted = false;
+        }
+        if (! std::isnan(t_scan.f_last)) {
+            t_last = t_scan.f_last;
+        }
+        f_checkpoints.insert(f_checkpoints.end(), t_scan.f_checkpoints.begin(), t_scan.f_checkpoints.end());
+        for (const auto& t_name: t_scan.f_names) {
+            if (t_name_set.insert(t_name).second) {
+                f_data_names.push_back(t_name);
+            }
+        }
+    }
+    if (! f_is_sorted) {
+        f_checkpoints.clear();
+    }
+}
+
+bool csv_file::load_index()
+{
+    // the index is valid only for the same file size and modification time //
+    std::ifstream t_input(f_path + ".hbidx", std::ios::binary);
+    if (! t_input) {
+        return false;
+    }
+    auto read_u64 = [&]() {
+        uint64_t t_value = 0;
+        t_input.read((char*) &t_value, sizeof(t_value));
+        return t_value;
+    };
+    
+    char t_magic[sizeof(g_csv_index_magic)];
+    t_input.read(t_magic, sizeof(t_magic));
+    if (! t_input || (memcmp(t_magic, g_csv_index_magic, sizeof(t_magic)) != 0)) {
+        return false;
+    }
+    if ((read_u64() != f_size) || ((int64_t) read_u64() != f_mtime) || (read_u64() != f_body_offset)) {
+        return false;
+    }
+    bool t_is_sorted = (read_u64() != 0);
+    
+    vector<string> t_data_names;
+    uint64_t t_number_of_names = read_u64();
+    for (uint64_t i = 0; t_input && (i < t_number_of_names); i++) {
+        uint64_t t_length = read_u64();
+        if (! t_input || (t_length > f_size)) {
+            return false;
+        }
+        string t_name(t_length, '\0');
+        t_input.read(&t_name[0], t_length);
+        t_data_names.push_back(std::move(t_name));
+    }
+    
+    vector<checkpoint> t_checkpoints;
+    uint64_t t_number_of_checkpoints = read_u64();
+    if (! t_input || (t_number_of_checkpoints > f_size / 2 + 1)) {
+        return false;
+    }
+    t_checkpoints.resize(t_number_of_checkpoints);
+    for (auto& t_checkpoint: t_checkpoints) {
+        t_checkpoint.f_offset = read_u64();
+        t_input.read((char*) &t_checkpoint.f_time, sizeof(double));
+        if (t_checkpoint.f_offset > f_size) {
+            return false;
+        }
+    }
+    if (! t_input) {
+        return false;
+    }
+
+    f_is_sorted = t_is_sorted;
+    if (f_name_column >= 0) {
+        f_data_names = std::move(t_data_names);
+    }
+    f_checkpoints = std::move(t_checkpoints);
+    hINFO(cerr << "CSV File: index loaded: " << f_path << ".hbidx" << endl);
+    
+    return true;
+}
+
+void csv_file::save_index()
+{
+    // written to a temporary file and renamed; a read-only location is not an error //
+    string t_path = f_path + ".hbidx";
+    string t_temporary_path = t_path + ".tmp" + to_string(getpid());
+    std::ofstream t_output(t_temporary_path, std::ios::binary);
+    if (! t_output) {
+        hINFO(cerr << "CSV File: unable to write index: " << t_path << endl);
+        return;
+    }
+    auto write_u64 = [&](uint64_t a_value) {
+        t_output.write((const char*) &a_value, sizeof(a_value));
+    };
+    
+    t_output.write(g_csv_index_magic, sizeof(g_csv_index_magic));
+    write_u64(f_size);
+    write_u64(f_mtime);
+    write_u64(f_body_offset);
+    write_u64(f_is_sorted ? 1 : 0);
+    write_u64((f_name_column >= 0) ? f_data_names.size() : 0);
+    if (f_name_column >= 0) {
+        for (const auto& t_name: f_data_names) {
+            write_u64(t_name.size());
+            t_output.write(t_name.data(), t_name.size());
+        }
+    }
+    write_u64(f_checkpoints.size());
+    for (const auto& t_checkpoint: f_checkpoints) {
+        write_u64(t_checkpoint.f_offset);
+        t_output.write((const char*) &t_checkpoint.f_time, sizeof(double));
+    }
+    t_output.close();
+
+    if (! t_output || (rename(t_temporary_path.c_str(), t_path.c_str()) != 0)) {
+        hINFO(cerr << "CSV File: unable to write index: " << t_path << endl);
+        remove(t_temporary_path.c_str());
+    }
+}
+
+size_t csv_file::find_line(double a_time) const
+{
+    // from the last checkpoint before a_time, lines are scanned up to the first at or after a_time //
+    auto iter = std::lower_bound(
+        f_checkpoints.begin(), f_checkpoints.end(), a_time,
+        [](const checkpoint& a_checkpoint, double a_time) { return a_checkpoint.f_time < a_time; }
+    );
+    size_t t_offset = (iter == f_checkpoints.begin()) ? f_body_offset : (iter-1)->f_offset;
+    
+    const char* t_end = f_data + f_size;
+    for (const char* p = f_data + t_offset; p < t_end; ) {
+        const char* t_eol = end_of_line(p, t_end);
+        double t_time = std::numeric_limits<double>::quiet_NaN();
+        for_each_field(p, t_eol, f_time_column, [&](int a_column, const char* a_begin, const char* a_end) {
+            if (a_column == f_time_column) {
+                t_time = parse_time(a_begin, a_end);
+            }
+        });
+        if (t_time >= a_time) {
+            return p - f_data;
+        }
+        p = t_eol + 1;
+    }
+
+    return f_size;
+}
+
+vector<string> csv_file::get_data_names()
+{
+    return f_data_names;
+}
+
+void csv_file::bind_inputs(sensor_table& a_sensor_table)
+{
+    sensor_config_by_names t_config("csv_column");
+    if (! f_input_delimiters.empty()) {
+        t_config.set_delimiters(f_input_delimiters, f_output_delimiter);
+    }
+    t_config.set_data_source(f_source_name);
+    t_config.load(a_sensor_table, f_data_names, f_basename);
+
+    hINFO(cerr << "CSV Column Binding: " << endl);
+    for (int t_number: a_sensor_table.find_like({{}})) {
+        if (! is_assigned_elsewhere(a_sensor_table[t_number])) {
+            this->bind_input(a_sensor_table[t_number]);
+        }
+    }
+}
+
+bool csv_file::bind_input(const sensor& a_sensor)
+{
+    string t_column = a_sensor.get_option("csv_column", "");
+    if (t_column.empty()) {
+        return false;
+    }
+    auto iter = std::find(f_data_names.begin(), f_data_names.end(), t_column);
+    if (iter == f_data_names.end()) {
+        hERROR(cerr << "CSV column not found: " << a_sensor.get_name().join(".") << ": " << t_column << endl);
+        return false;
+    }
+    hINFO(cerr << "    " << t_column << " => " << a_sensor.get_name().join(f_output_delimiter) << endl);
+    f_column_map[a_sensor.get_number()] = iter - f_data_names.begin();
+    
+    return true;
+}
+
+void csv_file::fetch_single(series& a_series, int a_sensor, double a_from, double a_to, double a_resampling_interval, const std::string& a_reducer)
+{
+    auto t_series_list = this->fetch({{a_sensor}}, a_from, a_to, a_resampling_interval, a_reducer);
+    if (t_series_list.size() == 1) {
+        a_series = std::move(t_series_list[0]);
+    }
+}
+
+vector<series> csv_file::fetch(const vector<int>& a_sensor_list, double a_from, double a_to, double a_resampling_interval, const std::string& a_reducer)
+{
+    // resampling is left to the caller, as the file has no aggregation to offer //
+    vector<series> t_series_list;
+    
+    // data-name index => series indices; wide files take the columns of the data names //
+    map<unsigned, vector<unsigned>> t_targets;
+    std::unique_lock<std::mutex> t_lock(f_binding_mutex);
+    for (auto t_sensor: a_sensor_list) {
+        auto iter = f_column_map.find(t_sensor);
+        if (iter != f_column_map.end()) {
+            t_targets[iter->second].push_back(t_series_list.size());
+        }
+        t_series_list.emplace_back(a_from, a_to);
+    }
+    t_lock.unlock();
+    
+    if (t_targets.empty() || (f_body_offset >= f_size)) {
+        return t_series_list;
+    }
+
+    size_t t_begin = f_body_offset, t_end = f_size;
+    if (f_is_sorted) {
+        t_begin = find_line(a_from);
+        t_end = std::max(t_begin, find_line(a_to));
+    }
+
+    // the name lookup of the long layout and the column lookup of the wide layout //
+    map<string, const vector<unsigned>*> t_name_targets;
+    vector<const vector<unsigned>*> t_column_targets(f_columns.size(), nullptr);
+    int t_last_column = f_time_column;
+    for (const auto& t_target: t_targets) {
+        if (f_name_column >= 0) {
+            t_name_targets[f_data_names[t_target.first]] = &t_target.second;
+        }
+        else {
+            int t_column = f_data_columns[t_target.first];
+            t_column_targets[t_column] = &t_target.second;
+            t_last_column = std::max(t_last_column, t_column);
+        }
+    }
+    if (f_name_column >= 0) {
+        t_last_column = std::max({f_time_column, f_name_column, f_value_column});
+    }
+
+    // each chunk fills its own partial series, which are concatenated in the file order //
+    vector<size_t> t_boundaries = split(t_begin, t_end);
+    size_t t_number_of_chunks = (t_boundaries.size() > 1) ? t_boundaries.size() - 1 : 0;
+    vector<vector<series>> t_partials(t_number_of_chunks, vector<series>(t_series_list.size(), series(a_from, a_to)));
+    
+    run_chunks(t_boundaries, [&](size_t a_index, size_t a_chunk_begin, size_t a_chunk_end) {
+        vector<series>& t_partial = t_partials[a_index];
+        const char* t_chunk_end = f_data + a_chunk_end;
+        struct value_field {
+            int f_column;
+            const char *f_begin, *f_end;
+        };
+        vector<value_field> t_fields;  // for the wide layout
+        for (const char* p = f_data + a_chunk_begin; p < t_chunk_end; ) {
+            const char* t_eol = end_of_line(p, t_chunk_end);
+            double t_time = std::numeric_limits<double>::quiet_NaN();
+            const vector<unsigned>* t_line_targets = nullptr;
+            const char *t_value_begin = nullptr, *t_value_end = nullptr;
+            t_fields.clear();
+            for_each_field(p, t_eol, t_last_column, [&](int a_column, const char* a_begin, const char* a_end) {
+                if (a_column == f_time_column) {
+                    t_time = parse_time(a_begin, a_end);
+                }
+                else if (a_column == f_name_column) {
+                    trim_field(a_begin, a_end);
+                    auto iter = t_name_targets.find(string(a_begin, a_end));
+                    t_line_targets = (iter != t_name_targets.end()) ? iter->second : nullptr;
+                }
+                else if (a_column == f_value_column) {
+                    t_value_begin = a_begin;
+                    t_value_end = a_end;
+                }
+                else if ((f_name_column < 0) && t_column_targets[a_column]) {
+                    t_fields.push_back({a_column, a_begin, a_end});
+                }
+            });
+            p = t_eol + 1;
+            if (std::isnan(t_time) || (t_time < a_from) || (t_time >= a_to)) {
+                continue;
+            }
+            
+            if (f_name_column >= 0) {
+                if (t_line_targets && t_value_begin) {
+                    double t_value = parse_number(t_value_begin, t_value_end);
+                    for (unsigned t_index: *t_line_targets) {
+                        t_partial[t_index].emplace_back(t_time, t_value);
+                    }
+                }
+            }
+            else {
+                for (auto& t_field: t_fields) {
+                    // empty fields are the gaps of the other columns, not data //
+                    trim_field(t_field.f_begin, t_field.f_end);
+                    if (t_field.f_begin == t_field.f_end) {
+                        continue;
+                    }
+                    double t_value = parse_number(t_field.f_begin, t_field.f_end);
+                    for (unsigned t_index: *t_column_targets[t_field.f_column]) {
+                        t_partial[t_index].emplace_back(t_time, t_value);
+                    }
+                }
+            }
+        }
+    });
+
+    for (size_t i = 0; i < t_series_list.size(); i++) {
+        size_t t_length = 0;
+        for (const auto& t_partial: t_partials) {
+            t_length += t_partial[i].size();
+        }
+        if (t_length == 0) {
+            continue;
+        }
+        auto& t = t_series_list[i].t();
+        auto& x = t_series_list[i].x();
+        t.reserve(t_length);
+        x.reserve(t_length);
+        for (const auto& t_partial: t_partials) {
+            t.insert(t.end(), t_partial[i].t().begin(), t_partial[i].t().end());
+            x.insert(x.end(), t_partial[i].x().begin(), t_partial[i].x().end());
+        }
+        if (! f_is_sorted && ! std::is_sorted(t.begin(), t.end())) {
+            vector<size_t> t_order(t_length);
+            for (size_t k = 0; k < t_length; k++) {
+                t_order[k] = k;
+            }
+            std::stable_sort(t_order.begin(), t_order.end(), [&t](size_t a, size_t b) { return t[a] < t[b]; });
+            vector<double> t_sorted_t(t_length), t_sorted_x(t_length);
+            for (size_t k = 0; k < t_length; k++) {
+                t_sorted_t[k] = t[t_order[k]];
+                t_sorted_x[k] = x[t_order[k]];
+            }
+            t = std::move(t_sorted_t);
+            x = std::move(t_sorted_x);
+        }
+    }
+    
+    return t_series_list;
+}
+
+
+
+synthetic_data_source::synthetic_data_source(unsigned a_number_of_channels)
+: synthetic_data_source(a_number_of_channels, parameters())
+{
+}
+
+synthetic_data_source::synthetic_data_source(unsigned a_number_of_channels, const parameters& a_parameters)
+: f_number_of_channels(a_number_of_channels), f_parameters(a_parameters)
+{
+}
+
+vector<string> synthetic_data_source::get_data_names()
+{
+    vector<string> t_names;
+    for (unsigned k = 0; k < f_number_of_channels; k++) {
+        t_names.push_back("synthetic_" + to_string(k));
+    }
+
+    return t_names;
+}
+
+void synthetic_data_source::bind_inputs(sensor_table& a_sensor_table)
+{
+    for (int t_number: a_sensor_table.find_like({{}})) {
+        if (! is_assigned_elsewhere(a_sensor_table[t_number])) {
+            this->bind_input(a_sensor_table[t_number]);
+        }
+    }
+}
+
+bool synthetic_data_source::bind_input(const sensor& a_sensor)
+{
+    string t_channel = a_sensor.get_option("synthetic_channel", "");
+    if (t_channel.empty()) {
+        return false;
+    }
+    unsigned t_index = stoul(t_channel);
+    if (t_index >= f_number_of_channels) {
+        hERROR(cerr << "synthetic channel out of range: " << a_sensor.get_name().join(".") << ": " << t_channel << endl);
+        return false;
+    }
+    f_channel_table[a_sensor.get_number()] = t_index;
+
+    return true;
+}
+
+double synthetic_data_source::uniform(uint64_t a_channel, int64_t a_index, uint64_t a_salt) const
+{
+    // splitmix64 over the identifiers, mapped to [0, 1) //
+    uint64_t z = f_parameters.f_seed;
+    for (uint64_t t_word: { a_channel, (uint64_t) a_index, a_salt }) {
+        z += 0x9e3779b97f4a7c15ULL + t_word;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        z = z ^ (z >> 31);
+    }
+    return (z >> 11) * (1.0 / 9007199254740992.0);
+}
+
+void synthetic_data_source::fetch_single(series& a_series, int a_sensor, double a_from, double a_to, double a_resampling_interval, const std::string& a_reducer)
+{
+    auto iter = f_channel_table.find(a_sensor);
+    if (iter == f_channel_table.end()) {
+        return;
+    }
+    const uint64_t t_channel = iter->second;
+    const parameters& p = f_parameters;
+    enum { e_salt_phase, e_salt_jitter, e_salt_gap, e_salt_nan, e_salt_noise };
+
+    // each channel has its own phase and period, so that the channels are not aligned //
+    const double dt = p.f_interval;
+    const double t_phase = uniform(t_channel, 0, e_salt_phase) * dt;
+    const double t_period = 600 * (1 + t_channel % 7);
+    const double t_pi = 3.14159265358979323846;
+    int64_t t_first = (int64_t) std::floor((a_from - t_phase) / dt) - 1;
+    int64_t t_last = (int64_t) std::ceil((a_to - t_phase) / dt) + 1;
+    a_series.t().reserve(a_series.size() + (t_last - t_first));
+    a_series.x().reserve(a_series.size() + (t_last - t_first));
+    
+    for (int64_t i = t_first; i <= t_last; i++) {
+        double t = t_phase + i * dt;
+        if (p.f_jitter > 0) {
+            t += p.f_jitter * dt * (uniform(t_channel, i, e_salt_jitter) - 0.5);
+        }
+        if ((t < a_from) || (t >= a_to)) {
+            continue;
+        }
+        if ((p.f_gap_ratio > 0) && (uniform(t_channel, (int64_t) std::floor(t / p.f_gap_length), e_salt_gap) < p.f_gap_ratio)) {
+            continue;
+        }
+        double x;
+        if ((p.f_nan_ratio > 0) && (uniform(t_channel, i, e_salt_nan) < p.f_nan_ratio)) {
+            x = std::numeric_limits<double>::quiet_NaN();
+        }
+        else {
+            x = (1 + t_channel) * std::sin(2 * t_pi * t / t_period) + 0.01 * (uniform(t_channel, i, e_salt_noise) - 0.5);
+        }
+        a_series.emplace_back(t, x);
+    }
+}
+
+
+
+void federated_data_source::add(const string& a_name, shared_ptr<data_source> a_source)
+{
+    a_source->f_source_name = a_name;
+    f_source_names.push_back(a_name);
+    f_sources.push_back(a_source);
+}
+
+vector<string> federated_data_source::get_source_names() const
+{
+    return f_source_names;
+}
+
+vector<string> federated_data_source::get_data_names()
+{
+    vector<string> t_data_names;
+    for (auto& t_source: f_sources) {
+        vector<string> t_names = t_source->get_data_names();
+        t_data_names.insert(t_data_names.end(), t_names.begin(), t_names.end());
+    }
+
+    return t_data_names;
+}
+
+int federated_data_source::find_source(const sensor& a_sensor)
+{
+    string t_name = a_sensor.get_option("data_source", "");
+    if (t_name.empty()) {
+        return -1;
+    }
+    auto iter = std::find(f_source_names.begin(), f_source_names.end(), t_name);
+    if (iter == f_source_names.end()) {
+        hERROR(cerr << "unknown data source: " << a_sensor.get_name().join(".") << ": " << t_name << endl);
+        return -2;
+    }
+
+    return iter - f_source_names.begin();
+}
+
+void federated_data_source::bind_inputs(sensor_table& a_sensor_table)
+{
+    // each source makes its own sensors from the data names, and binds the sensors it has //
+    for (unsigned i = 0; i < f_sources.size(); i++) {
+        hINFO(cerr << "Data Source \"" << f_source_names[i] << "\":" << endl);
+        f_sources[i]->bind_inputs(a_sensor_table);
+    }
+
+    hINFO(cerr << "Data Source Binding: " << endl);
+    for (int t_number: a_sensor_table.find_like({{}})) {
+        const sensor& t_sensor = a_sensor_table[t_number];
+        int t_index = find_source(t_sensor);
+        if (t_index >= 0) {
+            if (! f_sources[t_index]->is_bound(t_number) && ! f_sources[t_index]->bind_input(t_sensor)) {
+                hERROR(cerr << "not found in data source " << f_source_names[t_index] << ": " << t_sensor.get_name().join(".") << endl);
+                continue;
+            }
+        }
+        else if (t_index == -1) {
+            for (unsigned i = 0; i < f_sources.size(); i++) {
+                if (f_sources[i]->is_bound(t_number)) {
+                    t_index = i;
+                    break;
+                }
+            }
+        }
+        if (t_index >= 0) {
+            f_source_table[t_number] = t_index;
+            hINFO(cerr << "    " << t_sensor.get_name().join(".") << " => " << f_source_names[t_index] << endl);
+        }
+    }
+}
+
+bool federated_data_source::bind_input(const sensor& a_sensor)
+{
+    // called with f_binding_mutex held; each source is locked as it might be reading //
+    int t_index = find_source(a_sensor);
+    if (t_index == -2) {
+        return false;
+    }
+    for (unsigned i = 0; i < f_sources.size(); i++) {
+        if ((t_index >= 0) && ((int) i != t_index)) {
+            continue;
+        }
+        std::lock_guard<std::mutex> t_lock(f_sources[i]->f_binding_mutex);
+        if (f_sources[i]->is_bound(a_sensor.get_number()) || f_sources[i]->bind_input(a_sensor)) {
+            f_source_table[a_sensor.get_number()] = i;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void federated_data_source::fetch_single(series& a_series, int a_sensor, double a_from, double a_to, double a_resampling_interval, const std::string& a_reducer)
+{
+    auto t_series_list = this->fetch({{a_sensor}}, a_from, a_to, a_resampling_interval, a_reducer);
+    if (t_series_list.size() == 1) {
+        a_series = std::move(t_series_list[0]);
+    }
+}
+
+vector<series> federated_data_source::fetch(const vector<int>& a_sensor_list, double a_from, double a_to, double a_resampling_interval, const std::string& a_reducer)
+{
+    vector<series> t_series_list;
+    
+    // source index => positions in the sensor list //
+    map<unsigned, vector<unsigned>> t_position_table;
+    std::unique_lock<std::mutex> t_lock(f_binding_mutex);
+    for (unsigned i = 0; i < a_sensor_list.size(); i++) {
+        auto iter = f_source_table.find(a_sensor_list[i]);
+        if (iter != f_source_table.end()) {
+            t_position_table[iter->second].push_back(i);
+        }
+        t_series_list.emplace_back(a_from, a_to);
+    }
+    t_lock.unlock();
+
+    struct request {
+        data_source* f_source;
+        const string* f_name;
+        const vector<unsigned>* f_positions;
+        vector<series> f_result;
+        pipeline_metrics f_metrics;
+        std::exception_ptr f_error;
+    };
+    vector<request> t_requests;
+    for (const auto& t_entry: t_position_table) {
+        t_requests.push_back({f_sources[t_entry.first].get(), &f_source_names[t_entry.first], &t_entry.second, {}, {}, nullptr});
+    }
+    auto process = [&](request& a_request) {
+        vector<int> t_sensors;
+        for (unsigned t_position: *a_request.f_positions) {
+            t_sensors.push_back(a_sensor_list[t_position]);
+        }
+        try {
+            a_request.f_result = a_request.f_source->fetch(t_sensors, a_from, a_to, a_resampling_interval, a_reducer);
+        }
+        catch (std::exception& e) {
+            a_request.f_error = std::make_exception_ptr(std::runtime_error(*a_request.f_name + ": " + e.what()));
+        }
+        catch (...) {
+            a_request.f_error = std::current_exception();
+        }
+    };
+
+    // one source is read in the calling thread; several, concurrently in threads with their own metrics //
+    if (t_requests.size() == 1) {
+        process(t_requests[0]);
+    }
+    else {
+        vector<std::thread> t_threads;
+        for (auto& t_request: t_requests) {
+            t_threads.emplace_back([&process, &t_request]() {
+                metrics_scope t_scope(t_request.f_metrics);
+                process(t_request);
+            });
+        }
+        for (auto& t_thread: t_threads) {
+            t_thread.join();
+        }
+        for (const auto& t_request: t_requests) {
+            for (int k = 0; k < pipeline_metrics::e_number_of_stages; k++) {
+                auto t_stage = (pipeline_metrics::stage_t) k;
+                metrics_scope::add_time(t_stage, t_request.f_metrics.get_time(t_stage));
+            }
+            for (int k = 0; k < pipeline_metrics::e_number_of_counters; k++) {
+                auto t_counter = (pipeline_metrics::counter_t) k;
+                metrics_scope::add_count(t_counter, t_request.f_metrics.get_count(t_counter));
+            }
+        }
+    }
+
+    for (auto& t_request: t_requests) {
+        if (t_request.f_error) {
+            std::rethrow_exception(t_request.f_error);
+        }
+        for (unsigned k = 0; (k < t_request.f_positions->size()) && (k < t_request.f_result.size()); k++) {
+            t_series_list[(*t_request.f_positions)[k]] = std::move(t_request.f_result[k]);
+        }
+    }
+
+    return t_series_list;
 }
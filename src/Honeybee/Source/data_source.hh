@@ -10,6 +10,11 @@
 
 #include <string>
 #include <vector>
+#include <map>
+#include <set>
+#include <memory>
+#include <mutex>
+#include <cstdint>
 #include "utils.hh"
 #include "series.hh"
 #include "sensor_table.hh"
@@ -22,20 +27,38 @@ namespace honeybee {
 
     class data_source {
       public:
-        data_source() {}
+        data_source(): f_number_of_threads(0) {}
         virtual ~data_source() {}
         virtual vector<string> get_data_names() = 0;
         virtual void bind(sensor_table& a_sensor_table);
+        // lazy alternative to bind(): each sensor is bound at its first read //
+        void bind_lazily(shared_ptr<const sensor_table> a_sensor_table);
+        bool resolve(const vector<int>& a_sensor_list);  // false if a sensor needs the full bind()
+        void set_number_of_threads(unsigned a_number_of_threads) { f_number_of_threads = a_number_of_threads; } // 0 for auto
         virtual vector<series> read(const vector<int>& a_sensor_list, double a_from, double a_to, double a_resampling_interval=-1, const std::string& a_reducer="");
       protected:
         virtual void bind_inputs(sensor_table& sensor_table) = 0;
+        virtual bool bind_input(const sensor& a_sensor) { return false; }  // for lazy binding
+        virtual bool is_bound(int a_sensor) { return false; }  // true if the sensor is an input of this data store
+        bool is_assigned_elsewhere(const sensor& a_sensor) const;  // by the option "data_source", in a federation
         virtual vector<series> fetch(const vector<int>& a_sensor_list, double a_from, double a_to, double a_resampling_interval, const std::string& a_reducer);
         virtual void fetch_single(series& a_series, int a_sensor, double a_from, double a_to, double a_resampling_interval, const std::string& a_reducer) = 0;
       protected:
+        void bind_calibration(const sensor& a_sensor, const sensor_table& a_sensor_table);
         int find_input(int);
+        int find_linearity(int a_sensor);  // of the calibration chain, as calibration::get_linearity()
         void apply_calibration(int a_sensor, series& a_series);
       protected:
-        map<int, calibration> f_calibration_table;
+        map<int, calibration_index> f_calibration_table;
+        std::mutex f_calibration_mutex;  // for concurrent read() calls, which share the evaluators
+        unsigned f_number_of_threads;
+        string f_source_name;  // name in a federated_data_source, empty otherwise
+      protected:
+        shared_ptr<const sensor_table> f_lazy_sensor_table;  // null if bound eagerly
+        set<int> f_resolved_sensors;
+        std::mutex f_binding_mutex;  // lazy binding can happen while others are reading
+      protected:
+        friend class federated_data_source;
     };
 
     
@@ -50,10 +73,25 @@ namespace honeybee {
     
     class dripline_pgsql: public data_source {
       public:
-        dripline_pgsql(string a_uri, name_chain a_basename, const string& a_input_delimiters, const string& a_output_delimiters);
+        struct metadata {  // obtained from the DB at construction, can be given to skip the queries
+            bool f_has_idmap = false;
+            string f_sensorname_column;
+            vector<string> f_data_names;
+            string f_stamp;  // state of the end-point list when f_data_names was taken; empty if unknown
+        };
+      public:
+        dripline_pgsql(string a_uri, name_chain a_basename, const string& a_input_delimiters, const string& a_output_delimiters, const metadata* a_metadata=nullptr);
         vector<string> get_data_names() override;
+        const string& get_uri() const { return f_db_uri; }
+        metadata get_metadata();
+        string query_metadata_stamp();  // cheap check of the end-point list, empty if not possible
+        bool revalidate_metadata();  // false if the given end-point list is outdated; it will be re-read then
+        void share_connection(const dripline_pgsql& a_source) { f_pgsql = a_source.f_pgsql; }
+        void set_max_connections(unsigned a_max_connections) { f_pgsql->set_max_connections(a_max_connections); }
       protected:
         void bind_inputs(sensor_table& a_sensor_table) override;
+        bool bind_input(const sensor& a_sensor) override;
+        bool is_bound(int a_sensor) override { return f_endpoint_table.count(a_sensor) > 0; }
         vector<series> fetch(const vector<int>& a_sensor, double a_from, double a_to, double a_resampling_interval, const std::string& a_reducer) override;
         void fetch_single(series& a_series, int a_sensor, double a_from, double a_to, double a_resampling_interval, const std::string& a_reducer) override;
       protected:
@@ -61,22 +99,130 @@ namespace honeybee {
         vector<string> f_basename;
         string f_input_delimiters, f_output_delimiter;
       protected:
-        pgsql f_pgsql;
-        map<int, string> f_endpoint_table;
+        shared_ptr<pgsql> f_pgsql;
+        struct endpoint_binding {
+            double f_start, f_stop;  // [start, stop) in UNIX time
+            string f_endpoint;
+        };
+        map<int, vector<endpoint_binding>> f_endpoint_table;  // sorted in time, from the sensor versions
+        vector<endpoint_binding> make_bindings(const sensor& a_sensor, const set<string>* a_endpoint_list);
         vector<string> f_data_names;
+      protected:
+        // a sensor bound to different endpoints over time takes the rows of each endpoint in its period //
+        struct target {
+            unsigned f_index;
+            double f_start, f_stop;
+        };
+        // resampled on the requested grid from the rollup tables (see rollup.hh) and the raw data at the edges;
+        // false if no rollup is usable for the request //
+        bool fetch_rollup(vector<series>& a_series_list, const map<string, vector<target>>& a_series_index_table, const string& a_targets, double a_from, double a_to, double a_resampling_interval, const std::string& a_reducer);
+        int f_rollup_availability = -1;  // checked on the first resampled fetch
       protected:
         bool f_has_idmap;
         string f_sensorname_column;
+        string f_stamp;
     };
 
     
+    // CSV file, memory-mapped and parsed in parallel by line-aligned chunks. Layouts:
+    // - wide: a time column (TimeStamp in UNIX time, or DateTime in ISO 8601 UTC) and a column per
+    //   data name, such as the hb-get-data output
+    // - long: a name column (endpoint_name, sensor or name), a time column and a value column
+    //   (value_raw, value or value_cal), such as Dripline table exports
+    // A sidecar index (FILE.hbidx) holds the data names, time order and time checkpoints, so that
+    // a read of a time-sorted file parses only the lines in the range.
     class csv_file: public data_source {
       public:
+        csv_file(const string& a_path, name_chain a_basename=name_chain(), const string& a_input_delimiters="", const string& a_output_delimiter="");
+        ~csv_file() override;
         vector<string> get_data_names() override;
       protected:
+        void bind_inputs(sensor_table& a_sensor_table) override;
+        bool bind_input(const sensor& a_sensor) override;
+        bool is_bound(int a_sensor) override { return f_column_map.count(a_sensor) > 0; }
+        vector<series> fetch(const vector<int>& a_sensor_list, double a_from, double a_to, double a_resampling_interval, const std::string& a_reducer) override;
+        void fetch_single(series& a_series, int a_sensor, double a_from, double a_to, double a_resampling_interval, const std::string& a_reducer) override;
+      protected:
+        struct checkpoint {
+            uint64_t f_offset;  // start of a line
+            double f_time;
+        };
+        void parse_header();
+        bool load_index();
+        void build_index();
+        void save_index();
+        size_t find_line(double a_time) const;  // first line at or after a_time, for sorted files
+        vector<size_t> split(size_t a_begin, size_t a_end) const;  // line-aligned chunks for threads
+      protected:
+        string f_path;
+        vector<string> f_basename;
+        string f_input_delimiters, f_output_delimiter;
+        void* f_map;
+        const char* f_data;
+        size_t f_size, f_body_offset;
+        int64_t f_mtime;
+      protected:
+        vector<string> f_columns;
+        int f_time_column, f_name_column, f_value_column;  // name column < 0 for the wide layout
+        vector<string> f_data_names;
+        vector<int> f_data_columns;  // data-name index => column, for the wide layout
+        bool f_is_sorted;
+        vector<checkpoint> f_checkpoints;
+        map<int, unsigned> f_column_map;  // sensor => column (wide) or data-name index (long)
+    };
+
+
+    // Deterministic pseudo data, for benchmarks and tests without a data store.
+    // A value depends only on (seed, channel, sample index), not on the query range.
+    // Sensors are bound to channels by the "synthetic_channel" option (channel number).
+    class synthetic_data_source: public data_source {
+      public:
+        struct parameters {
+            double f_interval = 1;     // sampling interval [sec]
+            double f_jitter = 0;       // sampling-time jitter, as a fraction of the interval
+            double f_gap_ratio = 0;    // fraction of time blocks without data
+            double f_gap_length = 60;  // length of the time blocks for gaps [sec]
+            double f_nan_ratio = 0;    // fraction of NaN values
+            uint64_t f_seed = 1;
+        };
+      public:
+        synthetic_data_source(unsigned a_number_of_channels);
+        synthetic_data_source(unsigned a_number_of_channels, const parameters& a_parameters);
+        vector<string> get_data_names() override;
+      protected:
+        void bind_inputs(sensor_table& a_sensor_table) override;
+        bool bind_input(const sensor& a_sensor) override;
+        bool is_bound(int a_sensor) override { return f_channel_table.count(a_sensor) > 0; }
+        void fetch_single(series& a_series, int a_sensor, double a_from, double a_to, double a_resampling_interval, const std::string& a_reducer) override;
+        double uniform(uint64_t a_channel, int64_t a_index, uint64_t a_salt) const;
+      protected:
+        unsigned f_number_of_channels;
+        parameters f_parameters;
+        map<int, unsigned> f_channel_table;
+    };
+
+
+    // Named data sources used as one, e.g., the DBs of several teststands and archive files.
+    // Each sensor input is read from the first source that binds it, or from the one named by the
+    // sensor option "data_source". The calibration is applied here, after the inputs are fetched,
+    // so that it can take its input from any source. A read from several sources queries them
+    // concurrently, one thread per source.
+    class federated_data_source: public data_source {
+      public:
+        void add(const string& a_name, shared_ptr<data_source> a_source);
+        vector<string> get_source_names() const;
+        vector<string> get_data_names() override;
+      protected:
+        void bind_inputs(sensor_table& a_sensor_table) override;
+        bool bind_input(const sensor& a_sensor) override;
+        bool is_bound(int a_sensor) override { return f_source_table.count(a_sensor) > 0; }
+        vector<series> fetch(const vector<int>& a_sensor_list, double a_from, double a_to, double a_resampling_interval, const std::string& a_reducer) override;
         void fetch_single(series& a_series, int a_sensor, double a_from, double a_to, double a_resampling_interval, const std::string& a_reducer) override;
+        int find_source(const sensor& a_sensor);  // index of the named source, -1 if not named, -2 if not found
       protected:
-        map<int, unsigned> f_column_map;
+        vector<string> f_source_names;
+        vector<shared_ptr<data_source>> f_sources;
+        map<int, unsigned> f_source_table;  // sensor => source index
     };
 
 }
@@ -54,6 +54,11 @@ namespace honeybee {
         evaluator(const std::string& Expression): kebap::KPEvaluator(Expression) {
             fBuiltinFunctionTable->RegisterStaticObject(new kebap::KPHoneybeeObject());
         }
+        evaluator* Clone() const override {
+            evaluator* t_evaluator = new evaluator(ExpressionString());
+            t_evaluator->CopyParametersFrom(*this);
+            return t_evaluator;
+        }
     };
 }
 
@@ -8,6 +8,7 @@
 
 #include <tabree/KTreeFile.h>
 #include "honeybee.hh"
+#include "snapshot.hh"
 
 using namespace std;
 using namespace honeybee;
@@ -22,10 +23,30 @@ honeybee_app::honeybee_app()
     f_input_delimiters = "";
     f_output_delimiter = "";
    
-    f_sensor_table = make_shared<sensor_table>();
-    f_data_source = make_shared<empty_data_source>();
+    auto t_snapshot = getenv("HONEYBEE_SNAPSHOT");
+    f_snapshot_file_path = t_snapshot ? t_snapshot : "";
+    f_is_lazy = false;
+    f_max_db_connections = 1;
+    
+    auto t_metadata_cache = getenv("HONEYBEE_METADATA_CACHE");
+    auto t_metadata_cache_ttl = getenv("HONEYBEE_METADATA_CACHE_TTL");
+    f_metadata_cache_path = t_metadata_cache ? t_metadata_cache : "";
+    f_metadata_cache_ttl = t_metadata_cache_ttl ? atof(t_metadata_cache_ttl) : 3600;
+    
+    auto t_state = make_shared<state>();
+    t_state->f_sensor_table = make_shared<sensor_table>();
+    t_state->f_data_source = make_shared<empty_data_source>();
+    f_state = t_state;
     
     f_is_constructed = false;
+    f_is_date_given = false;
+    f_date_check_time = 0;
+    f_watcher_stop_fd = -1;
+}
+
+honeybee_app::~honeybee_app()
+{
+    enable_auto_reload(false);
 }
 
 void honeybee_app::add_config_file(const string& filepath)
@@ -38,9 +59,17 @@ void honeybee_app::add_dripline_db(const string& db_uri)
     f_dripline_db_uri = db_uri;
 }
 
+void honeybee_app::add_csv_file(const string& filepath)
+{
+    f_csv_file_path = filepath;
+}
+
 void honeybee_app::add_variable(const string& key, const tabree::KVariant& value)
 {
     f_variables.emplace_back(key, value);
+    if (key == "date") {
+        f_is_date_given = true;
+    }
 }
 
 void honeybee_app::set_delimiter(const std::string& input_delimiters, const std::string& output_delimiter)
@@ -53,116 +82,535 @@ void honeybee_app::set_delimiter(const std::string& input_delimiters, const std:
     }
 }
 
+void honeybee_app::set_snapshot_file(const std::string& filepath)
+{
+    f_snapshot_file_path = filepath;
+}
+
+void honeybee_app::set_metadata_cache(const std::string& filepath, double a_ttl)
+{
+    f_metadata_cache_path = filepath;
+    f_metadata_cache_ttl = a_ttl;
+}
+
+void honeybee_app::set_max_db_connections(unsigned a_max_connections)
+{
+    f_max_db_connections = a_max_connections;
+}
+
+void honeybee_app::set_lazy(bool a_is_lazy)
+{
+    f_is_lazy = a_is_lazy;
+}
+
 shared_ptr<sensor_table> honeybee_app::get_sensor_table()
 {
-    if (! f_is_constructed) {
-        construct();
-    }
-    
-    return f_sensor_table;
+    return get_bound_state()->f_sensor_table;
 }
 
 shared_ptr<data_source> honeybee_app::get_data_source()
+{
+    return get_bound_state()->f_data_source;
+}
+
+string honeybee_app::get_output_delimiter()
+{
+    return get_state()->f_output_delimiter;
+}
+
+pipeline_metrics honeybee_app::get_metrics()
+{
+    std::lock_guard<std::mutex> t_lock(f_metrics_mutex);
+    return f_metrics;
+}
+
+shared_ptr<const honeybee_app::state> honeybee_app::get_state()
 {
     if (! f_is_constructed) {
         construct();
     }
+    else if (! f_is_date_given && (time(NULL) >= f_date_check_time)) {
+        // a long-running process rebuilds on a new date, for valid_if and the current bindings //
+        f_date_check_time = time(NULL) + 60;
+        bool t_is_outdated = false; {
+            std::lock_guard<std::mutex> t_lock(f_build_mutex);
+            for (const auto& t_variable: f_variables) {
+                if (t_variable.first == "date") {
+                    t_is_outdated = (t_variable.second.As<string>() != datetime::now().as_string("%Y%m%d"));
+                    break;
+                }
+            }
+        }
+        if (t_is_outdated) {
+            hINFO(cerr << "date changed; reloading" << endl);
+            reload();
+        }
+    }
     
-    return f_data_source;
+    return atomic_load(&f_state);
+}
+
+shared_ptr<const honeybee_app::state> honeybee_app::get_bound_state()
+{
+    auto t_state = get_state();
+    if (! t_state->f_is_lazy) {
+        return t_state;
+    }
+
+    // the full binding, for callers which need the whole table; the DB connection is taken over //
+    std::lock_guard<std::mutex> t_lock(f_build_mutex);
+    t_state = atomic_load(&f_state);
+    if (! t_state->f_is_lazy) {
+        return t_state;
+    }
+    hINFO(cerr << "switching to full binding" << endl);
+    auto t_bound_state = make_shared<state>();
+    if (! build(*t_bound_state, t_state.get(), false)) {
+        return t_state;
+    }
+    atomic_store(&f_state, shared_ptr<const state>(t_bound_state));
+
+    return t_bound_state;
 }
 
 void honeybee_app::construct()
 {
+    std::lock_guard<std::mutex> t_lock(f_build_mutex);
     if (f_is_constructed) {
         return;
     }
-    f_is_constructed = true;
     
-    tabree::KTree t_config;
-    if (f_config_file_path.empty() && f_dripline_db_uri.empty()) {
+    if (f_config_file_path.empty() && f_dripline_db_uri.empty() && f_csv_file_path.empty()) {
         this->find_default_config();
     }
+
+    auto t_state = make_shared<state>();
+    build(*t_state, nullptr, f_is_lazy);
+    atomic_store(&f_state, shared_ptr<const state>(t_state));
+    
+    // set only after the state is published, as get_state() tests it without the lock //
+    f_is_constructed = true;
+}
+
+bool honeybee_app::reload()
+{
+    if (! f_is_constructed) {
+        construct();
+        return true;
+    }
+    
+    std::lock_guard<std::mutex> t_lock(f_build_mutex);
+    refresh_date();
+    auto t_current = atomic_load(&f_state);
+    auto t_state = make_shared<state>();
+    try {
+        if (! build(*t_state, t_current.get(), f_is_lazy)) {
+            hERROR(cerr << "reloading failed; the current sensor table is kept" << endl);
+            return false;
+        }
+    }
+    catch (std::exception &e) {
+        hERROR(cerr << e.what() << endl);
+        hERROR(cerr << "reloading failed; the current sensor table is kept" << endl);
+        return false;
+    }
+
+    // readers which already hold the current state continue with it until they release it //
+    atomic_store(&f_state, shared_ptr<const state>(t_state));
+    hINFO(cerr << "reloaded: " << t_state->f_sensor_table->find_like({{}}).size() << " sensors defined" << endl);
+    
+    return true;
+}
+
+bool honeybee_app::refresh_date()
+{
+    // called with f_build_mutex held; a date given by the user is kept //
+    if (f_is_date_given) {
+        return false;
+    }
+    string t_date = datetime::now().as_string("%Y%m%d");
+    for (auto& t_variable: f_variables) {
+        if ((t_variable.first == "date") && (t_variable.second.As<string>() != t_date)) {
+            t_variable.second = t_date;
+            return true;
+        }
+    }
     
+    return false;
+}
+
+bool honeybee_app::build(state& a_state, const state* a_current, bool a_is_lazy)
+{
+    a_state.f_sensor_table = make_shared<sensor_table>();
+    a_state.f_data_source = make_shared<empty_data_source>();
+    a_state.f_input_delimiters = f_input_delimiters;
+    a_state.f_output_delimiter = f_output_delimiter;
+    
+    string t_snapshot_key;
+    if (! f_snapshot_file_path.empty()) {
+        t_snapshot_key = make_snapshot_key();
+        if (! t_snapshot_key.empty() && load_snapshot(t_snapshot_key, a_state, a_is_lazy)) {
+            return true;
+        }
+    }
+    
+    tabree::KTree t_config;
     if (! f_config_file_path.empty()) {
         try {
             tabree::KTreeFile(f_config_file_path).Read(t_config);
         }
         catch (std::exception &e) {
             hERROR(cerr << e.what());
-            return;
+            return false;
         }
     }
     if (! f_dripline_db_uri.empty()) {
         t_config["data_source"]["dripline_psql"]["uri"] = f_dripline_db_uri;
     }
+    if (! f_csv_file_path.empty()) {
+        t_config["data_source"]["csv_file"]["path"] = f_csv_file_path;
+    }
 
     if (! f_config_file_path.empty()) {
         hINFO(cerr << "loading " << f_config_file_path << endl);
         sensor_config_by_file t_sensor_config;
         t_sensor_config.set_variables(f_variables);
-        t_sensor_config.load(*f_sensor_table, f_config_file_path);
-        hINFO(cerr << f_sensor_table->find_like({{}}).size() << " sensors defined" << endl);
+        t_sensor_config.load(*a_state.f_sensor_table, f_config_file_path);
+        hINFO(cerr << a_state.f_sensor_table->find_like({{}}).size() << " sensors defined" << endl);
     }
 
-    if (t_config["data_source"]["dripline_psql"]["uri"].IsVoid()) {
+    if (t_config["data_source"]["dripline_psql"]["uri"].IsVoid() && t_config["data_source"]["csv_file"]["path"].IsVoid()) {
         hINFO(cerr << "No data source defined");
     }
 
-    if (f_input_delimiters.empty()) {
+    string& t_input_delimiters = a_state.f_input_delimiters;
+    string& t_output_delimiter = a_state.f_output_delimiter;
+    if (t_input_delimiters.empty()) {
         if (! t_config["data_source"]["dripline_psql"]["delimiter"].IsVoid()) {
-            f_input_delimiters = t_config["data_source"]["dripline_psql"]["delimiter"].As<string>();
+            t_input_delimiters = t_config["data_source"]["dripline_psql"]["delimiter"].As<string>();
         }
         else if (! t_config["options"]["delimiter_input"].IsVoid()) {
-            f_input_delimiters = t_config["options"]["delimiter_input"].As<string>();
+            t_input_delimiters = t_config["options"]["delimiter_input"].As<string>();
         }
         else if (! t_config["options"]["delimiter"].IsVoid()) {
-            f_input_delimiters = t_config["options"]["delimiter"].As<string>();
+            t_input_delimiters = t_config["options"]["delimiter"].As<string>();
         }
         else {
-            f_input_delimiters = f_default_delimiters;
+            t_input_delimiters = f_default_delimiters;
         }
     }
-    if (f_output_delimiter.empty()) {
+    if (t_output_delimiter.empty()) {
         if (! t_config["options"]["delimiter_output"].IsVoid()) {
-            f_output_delimiter = t_config["options"]["delimiter_output"].As<string>();
+            t_output_delimiter = t_config["options"]["delimiter_output"].As<string>();
         }
         else if (! t_config["options"]["delimiter"].IsVoid()) {
-            f_output_delimiter = t_config["options"]["delimiter"].As<string>().substr(0, 1);
+            t_output_delimiter = t_config["options"]["delimiter"].As<string>().substr(0, 1);
         }
         else {
-            f_output_delimiter = f_input_delimiters.substr(0, 1);
+            t_output_delimiter = t_input_delimiters.substr(0, 1);
         }
     }
         
-    string t_db_uri = t_config["data_source"]["dripline_psql"]["uri"];
-    string t_basename = t_config["data_source"]["dripline_psql"]["basename"];
+    // repeated entries (told apart by "name") make several sources, which are federated into one //
+    const tabree::KTree& t_source_config = t_config["data_source"];
+    auto find_entries = [&](const string& a_type, const string& a_key) {
+        vector<const tabree::KTree*> t_entries;
+        const tabree::KTree& t_node = t_source_config[a_type];
+        for (unsigned i = 0; i < t_node.Length(); i++) {
+            if (! t_node[i][a_key].IsVoid()) {
+                t_entries.push_back(&t_node[i]);
+            }
+        }
+        return t_entries;
+    };
+    auto t_dripline_entries = f_csv_file_path.empty() ? find_entries("dripline_psql", "uri") : vector<const tabree::KTree*>();
+    auto t_csv_entries = find_entries("csv_file", "path");
+    bool t_is_federated = (t_dripline_entries.size() + t_csv_entries.size() > 1);
+    
+    string t_csv_path = t_source_config["csv_file"]["path"];
+    string t_db_uri = t_dripline_entries.empty() ? string("") : (*t_dripline_entries[0])["uri"].As<string>();
+    string t_basename = t_source_config["dripline_psql"]["basename"];
+    auto t_current_source = a_current ? dynamic_pointer_cast<dripline_pgsql>(a_current->f_data_source) : nullptr;
+    vector<shared_ptr<dripline_pgsql>> t_driplines;
+    vector<bool> t_is_metadata_cached;
+    if (t_is_federated) {
+        auto t_federation = make_shared<federated_data_source>();
+        for (unsigned i = 0; i < t_dripline_entries.size(); i++) {
+            const tabree::KTree& t_node = *t_dripline_entries[i];
+            string t_name = t_node["name"].Or("dripline_psql" + to_string(i));
+            try {
+                bool t_is_cached = false;
+                auto t_source = open_dripline(t_node["uri"], t_node["basename"], a_state, t_is_cached);
+                t_driplines.push_back(t_source);
+                t_is_metadata_cached.push_back(t_is_cached);
+                t_federation->add(t_name, t_source);
+            }
+            catch (std::exception &e) {
+                hERROR(cerr << "data source " << t_name << ": " << e.what() << endl);
+            }
+        }
+        for (unsigned i = 0; i < t_csv_entries.size(); i++) {
+            const tabree::KTree& t_node = *t_csv_entries[i];
+            string t_name = t_node["name"].Or("csv_file" + to_string(i));
+            try {
+                hINFO(cerr << "CSV Datasource: " << t_node["path"].As<string>() << endl);
+                t_federation->add(t_name, make_shared<csv_file>(
+                    t_node["path"], name_chain{t_node["basename"].As<string>(), t_input_delimiters}, t_input_delimiters, t_output_delimiter
+                ));
+            }
+            catch (std::exception &e) {
+                hERROR(cerr << "data source " << t_name << ": " << e.what() << endl);
+            }
+        }
+        a_state.f_data_source = t_federation;
+        t_db_uri.clear();
+        t_basename.clear();
+    }
+    else if (! t_csv_path.empty()) {
+        // a CSV file takes the place of the DB, e.g., for offline analysis of exported data //
+        hINFO(cerr << "CSV Datasource: " << t_csv_path << endl);
+        t_db_uri.clear();
+        t_basename = t_source_config["csv_file"]["basename"].As<string>();
+        try {
+            a_state.f_data_source = make_shared<csv_file>(
+                t_csv_path, name_chain{t_basename, t_input_delimiters}, t_input_delimiters, t_output_delimiter
+            );
+        }
+        catch (std::exception &e) {
+            hERROR(cerr << e.what() << endl);
+        }
+    }
+    else if (t_db_uri.empty()) {
+        hERROR(cerr << "No Dripline Datasource found" << endl);
+    }
+    else if (t_current_source && (a_current->f_db_uri == t_db_uri)) {
+        // on reloading, the DB connection and the table layout are taken over; the end-point list is re-read //
+        dripline_pgsql::metadata t_metadata = t_current_source->get_metadata();
+        t_metadata.f_data_names.clear();
+        auto t_source = make_shared<dripline_pgsql>(
+            t_db_uri, name_chain{t_basename, t_input_delimiters}, t_input_delimiters, t_output_delimiter, &t_metadata
+        );
+        t_source->share_connection(*t_current_source);
+        t_driplines.push_back(t_source);
+        t_is_metadata_cached.push_back(false);
+        a_state.f_data_source = t_source;
+    }
+    else {
+        bool t_is_cached = false;
+        auto t_source = open_dripline(t_db_uri, t_basename, a_state, t_is_cached);
+        t_driplines.push_back(t_source);
+        t_is_metadata_cached.push_back(t_is_cached);
+        a_state.f_data_source = t_source;
+    }
+    a_state.f_db_uri = t_db_uri;
+    a_state.f_db_basename = t_basename;
+    
+    for (auto& t_dripline: t_driplines) {
+        t_dripline->set_max_connections(f_max_db_connections);
+    }
+    
+    a_state.f_is_lazy = a_is_lazy;
+    if (a_is_lazy) {
+        // the end-point list is not needed for lazy binding, and not saved therefore //
+        a_state.f_data_source->bind_lazily(a_state.f_sensor_table);
+        return true;
+    }
+    a_state.f_data_source->bind(*a_state.f_sensor_table);
+
+    for (unsigned i = 0; i < t_driplines.size(); i++) {
+        if (! f_metadata_cache_path.empty() && ! t_is_metadata_cached[i]) {
+            if (metadata_cache(f_metadata_cache_path).save(t_driplines[i]->get_uri(), t_driplines[i]->get_metadata())) {
+                hINFO(cerr << "DB metadata cache saved: " << f_metadata_cache_path << endl);
+            }
+        }
+    }
+    if (! t_snapshot_key.empty() && t_csv_path.empty() && ! t_is_federated) {
+        // snapshots hold a single DB; the CSV file is not a part of the snapshot key, and its binding is cheap anyway //
+        save_snapshot(t_snapshot_key, a_state);
+    }
+
+    return true;
+}
+
+shared_ptr<dripline_pgsql> honeybee_app::open_dripline(const string& a_uri, const string& a_basename, const state& a_state, bool& a_is_metadata_cached)
+{
+    hINFO(cerr << "Dripline Datasource: " << a_uri << endl);
+    dripline_pgsql::metadata t_metadata;
+    double t_age = -1;
+    bool t_is_loaded = false;
+    if (! f_metadata_cache_path.empty() && metadata_cache(f_metadata_cache_path).load(a_uri, t_metadata, t_age)) {
+        hINFO(cerr << "using DB metadata cache " << f_metadata_cache_path << " (" << t_age << " s old)" << endl);
+        t_is_loaded = true;
+    }
+    auto t_source = make_shared<dripline_pgsql>(
+        a_uri, name_chain{a_basename, a_state.f_input_delimiters}, a_state.f_input_delimiters, a_state.f_output_delimiter,
+        t_is_loaded ? &t_metadata : nullptr
+    );
+    if (t_is_loaded && (t_age > f_metadata_cache_ttl)) {
+        // saved again after binding with a new time, either as is or with the end-point list re-read //
+        bool t_is_valid = t_source->revalidate_metadata();
+        hINFO(cerr << "DB metadata cache " << (t_is_valid ? "still valid" : "outdated") << endl);
+    }
+    a_is_metadata_cached = t_is_loaded && (t_age <= f_metadata_cache_ttl);
+
+    return t_source;
+}
+
+string honeybee_app::make_snapshot_key()
+{
+    vector<string> t_files;
+    if (! f_config_file_path.empty()) {
+        t_files.push_back(f_config_file_path);
+    }
+    vector<string> t_parameters = {
+        f_dripline_db_uri, f_csv_file_path, f_input_delimiters, f_output_delimiter
+    };
+    for (const auto& var: f_variables) {
+        t_parameters.push_back(var.first + "=" + var.second.As<string>());
+    }
+    
+    return app_snapshot::make_key(t_files, t_parameters);
+}
+
+bool honeybee_app::load_snapshot(const string& a_key, state& a_state, bool a_is_lazy)
+{
+    app_snapshot t_snapshot;
+    if (! t_snapshot.load(f_snapshot_file_path, a_key)) {
+        return false;
+    }
+    hINFO(cerr << "loading snapshot " << f_snapshot_file_path << endl);
+    
+    // the DB URI is not in the snapshot; it is taken from the inputs, which are covered by the key //
+    string t_db_uri;
+    if (! t_snapshot.f_db_uri_hash.empty()) {
+        t_db_uri = f_dripline_db_uri;
+        if (t_db_uri.empty() && ! f_config_file_path.empty()) {
+            tabree::KTree t_config;
+            try {
+                tabree::KTreeFile(f_config_file_path).Read(t_config);
+            }
+            catch (std::exception &e) {
+                hERROR(cerr << e.what());
+                return false;
+            }
+            if (! t_config["data_source"]["dripline_psql"]["uri"].IsVoid()) {
+                t_db_uri = t_config["data_source"]["dripline_psql"]["uri"].As<string>();
+            }
+        }
+        if (app_snapshot::make_key({}, {t_db_uri}) != t_snapshot.f_db_uri_hash) {
+            hINFO(cerr << "snapshot not used: DB URI not found" << endl);
+            return false;
+        }
+    }
+    
+    shared_ptr<dripline_pgsql> t_dripline;
     if (t_db_uri.empty()) {
         hERROR(cerr << "No Dripline Datasource found" << endl);
     }
     else {
-        hINFO(cerr << "Dripline Datasource: " << t_db_uri << endl);
-        f_data_source = make_shared<dripline_pgsql>(
-            t_db_uri, name_chain{t_basename, f_input_delimiters}, f_input_delimiters, f_output_delimiter
+        t_dripline = make_shared<dripline_pgsql>(
+            t_db_uri, name_chain{t_snapshot.f_db_basename, t_snapshot.f_input_delimiters},
+            t_snapshot.f_input_delimiters, t_snapshot.f_output_delimiter, &t_snapshot.f_db_metadata
         );
+        t_dripline->set_max_connections(f_max_db_connections);
     }
     
-    f_data_source->bind(*f_sensor_table);
+    // the sensors inferred from the end-points are in the snapshot; a changed end-point list needs the full build //
+    double t_age = (long) datetime::now() - t_snapshot.f_time;
+    bool t_is_revalidated = false;
+    if (t_dripline && (t_age > f_metadata_cache_ttl)) {
+        if (! t_dripline->revalidate_metadata()) {
+            hINFO(cerr << "snapshot not used: DB end-point list changed or not verifiable (" << t_age << " s old)" << endl);
+            return false;
+        }
+        t_is_revalidated = true;
+    }
+    
+    for (const auto& t_sensor: t_snapshot.f_sensors) {
+        a_state.f_sensor_table->add(t_sensor);
+    }
+    a_state.f_input_delimiters = t_snapshot.f_input_delimiters;
+    a_state.f_output_delimiter = t_snapshot.f_output_delimiter;
+    a_state.f_db_uri = t_db_uri;
+    a_state.f_db_basename = t_snapshot.f_db_basename;
+    if (t_dripline) {
+        a_state.f_data_source = t_dripline;
+    }
+    
+    a_state.f_is_lazy = a_is_lazy;
+    if (a_is_lazy) {
+        a_state.f_data_source->bind_lazily(a_state.f_sensor_table);
+    }
+    else {
+        a_state.f_data_source->bind(*a_state.f_sensor_table);
+    }
+    if (t_is_revalidated) {
+        save_snapshot(a_key, a_state);  // with a new time
+    }
+
+    return true;
 }
 
-std::vector<std::string> honeybee_app::find_like(const std::string a_name)
+void honeybee_app::save_snapshot(const string& a_key, const state& a_state)
 {
-    vector<string> t_name_list;
+    app_snapshot t_snapshot;
+    t_snapshot.f_key = a_key;
+    t_snapshot.f_time = (long) datetime::now();
+    t_snapshot.f_input_delimiters = a_state.f_input_delimiters;
+    t_snapshot.f_output_delimiter = a_state.f_output_delimiter;
+    for (int t_number: a_state.f_sensor_table->find_like({{}})) {
+        t_snapshot.f_sensors.push_back((*a_state.f_sensor_table)[t_number]);
+    }
+    auto t_dripline = dynamic_pointer_cast<dripline_pgsql>(a_state.f_data_source);
+    if (t_dripline) {
+        t_snapshot.f_db_uri_hash = app_snapshot::make_key({}, {a_state.f_db_uri});
+        t_snapshot.f_db_basename = a_state.f_db_basename;
+        t_snapshot.f_db_metadata = t_dripline->get_metadata();
+    }
     
-    if (! f_is_constructed) {
-        construct();
+    if (t_snapshot.save(f_snapshot_file_path)) {
+        hINFO(cerr << "snapshot saved: " << f_snapshot_file_path << endl);
     }
-    if (! f_sensor_table || ! f_data_source) {
-        return t_name_list;
+}
+
+vector<int> honeybee_app::select(const state& a_state, const string& a_name)
+{
+    if (! sensor_pattern::is_pattern(a_name)) {
+        return a_state.f_sensor_table->find_like(name_chain::lookup(a_name, a_state.f_input_delimiters));
     }
 
-    auto t_matched_sensors = f_sensor_table->find_like(name_chain(a_name, f_input_delimiters));
+    // pattern results are kept for the lifetime of the state (i.e., until reloading) //
+    std::lock_guard<std::mutex> t_lock(a_state.f_selection_mutex);
+    auto iter = a_state.f_selection_cache.find(a_name);
+    if (iter != a_state.f_selection_cache.end()) {
+        return iter->second;
+    }
+    vector<int> t_matches;
+    try {
+        sensor_pattern t_pattern(a_name, a_state.f_input_delimiters, a_state.f_output_delimiter);
+        t_matches = a_state.f_sensor_table->find_matching(t_pattern);
+    }
+    catch (std::regex_error &e) {
+        hERROR(cerr << "bad sensor pattern: " << a_name << ": " << e.what() << endl);
+    }
+    if (a_state.f_selection_cache.size() >= 1024) {
+        a_state.f_selection_cache.clear();
+    }
+    a_state.f_selection_cache[a_name] = t_matches;
+    
+    return t_matches;
+}
+
+std::vector<std::string> honeybee_app::find_like(const std::string a_name)
+{
+    vector<string> t_name_list;
+    
+    auto t_state = get_bound_state();
+    const sensor_table& t_sensor_table = *t_state->f_sensor_table;
+    
+    auto t_matched_sensors = select(*t_state, a_name);
     for (auto& t_number: t_matched_sensors) {
-        t_name_list.push_back((*f_sensor_table)[t_number].get_name().join(f_output_delimiter));
+        t_name_list.push_back(t_sensor_table[t_number].get_name().join(t_state->f_output_delimiter));
     }
 
     return t_name_list;
@@ -170,45 +618,77 @@ std::vector<std::string> honeybee_app::find_like(const std::string a_name)
 
 series_bundle honeybee_app::read(const vector<std::string>& a_sensor_list, double a_from, double a_to, double a_resampling_interval, const std::string& a_reducer)
 {
-    if (! f_is_constructed) {
-        construct();
-    }
-    if (! f_sensor_table || ! f_data_source) {
-        return series_bundle();
-    }
+    // the state is held until the end of this read, even if a reload replaces it meanwhile //
+    auto t_state = get_state();
 
     vector<string> t_sensor_name_list;
     vector<int> t_sensor_number_list;
-    for (auto& t_name: a_sensor_list) {
-        auto t_matched_sensors = f_sensor_table->find_like(name_chain(t_name, f_input_delimiters));
-        if (t_matched_sensors.empty()) {
-            hINFO(cerr << "undefined sensor name: " << t_name << endl);
-            t_sensor_number_list.push_back(0);
-            t_sensor_name_list.push_back(t_name);
-            continue;
-        }
-        if (t_matched_sensors.size() > 1) {
-            for (auto& t_number: t_matched_sensors) {
-                t_sensor_number_list.push_back(t_number);
-                t_sensor_name_list.push_back((*f_sensor_table)[t_number].get_name().join(f_output_delimiter));
+    auto t_resolve_names = [&](bool a_is_reporting) {
+        bool t_is_complete = true;
+        const sensor_table& t_sensor_table = *t_state->f_sensor_table;
+        t_sensor_name_list.clear();
+        t_sensor_number_list.clear();
+        for (auto& t_name: a_sensor_list) {
+            auto t_matched_sensors = select(*t_state, t_name);
+            if (t_matched_sensors.empty()) {
+                if (a_is_reporting) {
+                    hINFO(cerr << "undefined sensor name: " << t_name << endl);
+                }
+                t_is_complete = false;
+                t_sensor_number_list.push_back(0);
+                t_sensor_name_list.push_back(t_name);
+                continue;
+            }
+            if ((t_matched_sensors.size() > 1) || sensor_pattern::is_pattern(t_name)) {
+                for (auto& t_number: t_matched_sensors) {
+                    t_sensor_number_list.push_back(t_number);
+                    t_sensor_name_list.push_back(t_sensor_table[t_number].get_name().join(t_state->f_output_delimiter));
+                }
+            }
+            else {
+                t_sensor_number_list.push_back(t_matched_sensors.front());
+                t_sensor_name_list.push_back(t_name);
             }
         }
-        else {
-            t_sensor_number_list.push_back(t_matched_sensors.front());
-            t_sensor_name_list.push_back(t_name);
-        }
+        return t_is_complete;
+    };
+    
+    if (! t_state->f_is_lazy) {
+        t_resolve_names(true);
+    }
+    else if (! t_resolve_names(false) || ! t_state->f_data_source->resolve(t_sensor_number_list)) {
+        // names only inferred from the end-point list, or sensors without explicit end-points //
+        t_state = get_bound_state();
+        t_resolve_names(true);
     }
 
     hINFO(cerr << "getting data ");
     hINFO(cerr << "(" << datetime(a_from).as_string() << " to " << datetime(a_to).as_string() << ", ");
     hINFO(cerr << t_sensor_number_list.size() << " sensors)..." << flush);
-    datetime start = datetime::now();
-    vector<series> t_series_list = f_data_source->read(
-        t_sensor_number_list, datetime(a_from), datetime(a_to),
-        a_resampling_interval, a_reducer
-    );
-    datetime stop = datetime::now();
-    hINFO(cerr << "done. (" << (stop-start) << " s)" << endl);
+    pipeline_metrics t_metrics;
+    vector<series> t_series_list; {
+        metrics_scope t_scope(t_metrics);
+        t_series_list = t_state->f_data_source->read(
+            t_sensor_number_list, datetime(a_from), datetime(a_to),
+            a_resampling_interval, a_reducer
+        );
+        long t_number_of_points = 0;
+        for (const auto& t_series: t_series_list) {
+            t_number_of_points += t_series.size();
+        }
+        metrics_scope::add_count(pipeline_metrics::e_counter_reads, 1);
+        metrics_scope::add_count(pipeline_metrics::e_counter_points, t_number_of_points);
+    }
+    hINFO(cerr << "done. (");
+    hINFO(cerr << "query " << t_metrics.get_time(pipeline_metrics::e_stage_query) << " s, ");
+    hINFO(cerr << "transfer " << t_metrics.get_time(pipeline_metrics::e_stage_transfer) << " s, ");
+    hINFO(cerr << "parse " << t_metrics.get_time(pipeline_metrics::e_stage_parse) << " s, ");
+    hINFO(cerr << "calibrate " << t_metrics.get_time(pipeline_metrics::e_stage_calibrate) << " s; ");
+    hINFO(cerr << t_metrics.get_count(pipeline_metrics::e_counter_rows) << " rows)" << endl);
+    {
+        std::lock_guard<std::mutex> t_lock(f_metrics_mutex);
+        f_metrics += t_metrics;
+    }
 
     // Resampling might have be done on the server-side, might not.
     // We will perform resampling on the returned result here; server-side resampling is to reduce the data size.
@@ -250,3 +730,109 @@ void honeybee_app::find_default_config()
         }
     }
 }
+
+
+
+#include <unistd.h>
+#include <poll.h>
+#include <cerrno>
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+void honeybee_app::enable_auto_reload(bool a_is_enabled)
+{
+    if (f_watcher.joinable()) {
+        char t_byte = 0;
+        if (write(f_watcher_stop_fd, &t_byte, 1) < 0) {
+            hERROR(cerr << "unable to stop config watcher" << endl);
+        }
+        f_watcher.join();
+        close(f_watcher_stop_fd);
+        f_watcher_stop_fd = -1;
+    }
+    if (! a_is_enabled) {
+        return;
+    }
+    
+#ifdef __linux__
+    get_state();  // resolves the config file path
+    if (f_config_file_path.empty()) {
+        hERROR(cerr << "auto reload: no config file to watch" << endl);
+        return;
+    }
+    int t_pipe[2];
+    if (pipe(t_pipe) < 0) {
+        hERROR(cerr << "auto reload: unable to create pipe" << endl);
+        return;
+    }
+    f_watcher_stop_fd = t_pipe[1];
+    f_watcher = std::thread(&honeybee_app::watch_config, this, t_pipe[0]);
+#else
+    hERROR(cerr << "auto reload is not supported on this platform" << endl);
+#endif
+}
+
+void honeybee_app::watch_config(int a_stop_fd)
+{
+#ifdef __linux__
+    // editors often replace a file instead of writing into it, therefore the directory is watched //
+    string t_dir = ".", t_file = f_config_file_path;
+    auto t_slash = f_config_file_path.find_last_of('/');
+    if (t_slash != string::npos) {
+        t_dir = f_config_file_path.substr(0, t_slash);
+        t_file = f_config_file_path.substr(t_slash+1);
+    }
+    
+    int t_fd = inotify_init1(IN_CLOEXEC);
+    if ((t_fd < 0) || (inotify_add_watch(t_fd, t_dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE) < 0)) {
+        hERROR(cerr << "auto reload: unable to watch " << t_dir << endl);
+        if (t_fd >= 0) {
+            close(t_fd);
+        }
+        close(a_stop_fd);
+        return;
+    }
+    hINFO(cerr << "watching config directory: " << t_dir << endl);
+
+    // after a change, waits until the events settle, as a save can consist of several steps //
+    const int t_settling_time_ms = 200;
+    bool t_is_changed = false;
+    while (true) {
+        struct pollfd t_fds[2] = { { t_fd, POLLIN, 0 }, { a_stop_fd, POLLIN, 0 } };
+        int t_result = poll(t_fds, 2, t_is_changed ? t_settling_time_ms : -1);
+        if (t_result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            hERROR(cerr << "auto reload: " << strerror(errno) << endl);
+            break;
+        }
+        if (t_fds[1].revents) {
+            break;
+        }
+        if (t_result == 0) {
+            t_is_changed = false;
+            hINFO(cerr << "config changed; reloading " << f_config_file_path << endl);
+            reload();
+            continue;
+        }
+        
+        alignas(struct inotify_event) char t_buffer[4096];
+        ssize_t t_length = ::read(t_fd, t_buffer, sizeof(t_buffer));
+        for (ssize_t k = 0; k < t_length; ) {
+            const struct inotify_event* t_event = (const struct inotify_event*) (t_buffer + k);
+            if (t_event->len > 0) {
+                string t_name = t_event->name;
+                if ((t_name == t_file) || ((t_name.size() > 4) && (t_name.substr(t_name.size()-4) == ".ktf"))) {
+                    t_is_changed = true;
+                }
+            }
+            k += sizeof(struct inotify_event) + t_event->len;
+        }
+    }
+
+    close(t_fd);
+#endif
+    close(a_stop_fd);
+}
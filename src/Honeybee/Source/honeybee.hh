@@ -9,13 +9,19 @@
 #define HONEYBEE_HH_ 1
 
 #include <string>
+#include <vector>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <atomic>
+#include <thread>
 #include <tabree/KVariant.h>
 #include "utils.hh"
 #include "series.hh"
 #include "sensor_table.hh"
 #include "calibration.hh"
 #include "data_source.hh"
+#include "metrics.hh"
 
 
 namespace honeybee {
@@ -23,28 +29,79 @@ namespace honeybee {
     class honeybee_app {
       public:
         honeybee_app();
-        virtual ~honeybee_app() {}
+        virtual ~honeybee_app();
         void add_config_file(const std::string& filepath);
         void add_dripline_db(const std::string& db_uri);
+        void add_csv_file(const std::string& filepath);  // instead of the DB; see csv_file for the layouts
         void add_variable(const std::string& key, const tabree::KVariant& value);
         void set_delimiter(const std::string& input_delimiters, const std::string& output_delimiter="");
+        void set_snapshot_file(const std::string& filepath);
+        // DB metadata cache, used as is for a_ttl seconds and revalidated with a cheap query afterwards
+        void set_metadata_cache(const std::string& filepath, double a_ttl=3600);
+        // Binds sensors on their first read only, instead of the whole table at construction.
+        // Sensors not explicitly bound to a data-store input fall back to the full binding.
+        void set_lazy(bool a_is_lazy=true);
+        // number of DB connections for concurrent reads from threads (default 1)
+        void set_max_db_connections(unsigned a_max_connections);
         std::shared_ptr<sensor_table> get_sensor_table();
         std::shared_ptr<data_source> get_data_source();
-        std::vector<std::string> find_like(const std::string a_name);
+        std::vector<std::string> find_like(const std::string a_name);  // a_name can be a glob or regex pattern (sensor_pattern)
         series_bundle read(const vector<std::string>& a_sensor_list, double a_start, double a_stop, double a_resampling_interval=-1, const std::string& a_reducer="");
-        std::string get_output_delimiter() const { return f_output_delimiter; }
+        std::string get_output_delimiter();
+        // stage times and counters accumulated over all the read() calls so far
+        pipeline_metrics get_metrics();
+      public:
+        // Rebuilds the sensor table and the data-source binding from the config files.
+        // Readers holding the previous ones (in-flight read() etc.) continue with them;
+        // on failure, the current ones are kept.
+        bool reload();
+        // Watches the config directory in a background thread, and reloads on changes (Linux only).
+        void enable_auto_reload(bool a_is_enabled=true);
       protected:
+        struct state {
+            std::shared_ptr<sensor_table> f_sensor_table;
+            std::shared_ptr<data_source> f_data_source;
+            std::string f_input_delimiters, f_output_delimiter;
+            std::string f_db_uri, f_db_basename;
+            bool f_is_lazy = false;
+            mutable std::mutex f_selection_mutex;
+            mutable std::map<std::string, std::vector<int>> f_selection_cache;  // pattern => sensors
+        };
+        std::shared_ptr<const state> get_state();
+        std::shared_ptr<const state> get_bound_state();
+        std::vector<int> select(const state& a_state, const std::string& a_name);
         void construct();
+        bool build(state& a_state, const state* a_current, bool a_is_lazy=false);
         void find_default_config();
+        std::shared_ptr<dripline_pgsql> open_dripline(const std::string& a_uri, const std::string& a_basename, const state& a_state, bool& a_is_metadata_cached);
+        std::string make_snapshot_key();
+        bool load_snapshot(const std::string& a_key, state& a_state, bool a_is_lazy);
+        void save_snapshot(const std::string& a_key, const state& a_state);
+        void watch_config(int a_stop_fd);
+        bool refresh_date();
       protected:
         std::string f_config_file_path;
         std::string f_dripline_db_uri;
+        std::string f_csv_file_path;
+        std::string f_snapshot_file_path;
+        std::string f_metadata_cache_path;
+        double f_metadata_cache_ttl;
         std::string f_default_delimiters, f_input_delimiters, f_output_delimiter;
+        bool f_is_lazy;
+        unsigned f_max_db_connections;
       protected:
-        bool f_is_constructed;
-        std::shared_ptr<sensor_table> f_sensor_table;
-        std::shared_ptr<data_source> f_data_source;
+        std::atomic<bool> f_is_constructed;
+        std::mutex f_build_mutex;
+        std::shared_ptr<const state> f_state;  // replaced as a whole by atomic_store()
         sensor_config_by_file::variables f_variables;
+        bool f_is_date_given;  // otherwise "date" follows the current date, see refresh_date()
+        std::atomic<long> f_date_check_time;
+      protected:
+        std::thread f_watcher;
+        int f_watcher_stop_fd;
+      protected:
+        std::mutex f_metrics_mutex;
+        pipeline_metrics f_metrics;
     };
     
 }
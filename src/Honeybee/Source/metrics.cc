@@ -0,0 +1,123 @@
+/*
+ * metrics.cc
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sanshiro Enomoto <sanshiro@uw.edu>
+ */
+
+#include <string>
+#include <sstream>
+#include "metrics.hh"
+
+using namespace std;
+using namespace honeybee;
+
+
+static thread_local metrics_scope* g_current_metrics_scope = nullptr;
+
+
+void pipeline_metrics::clear()
+{
+    for (auto& t_time: f_time) {
+        t_time = 0;
+    }
+    for (auto& t_count: f_count) {
+        t_count = 0;
+    }
+}
+
+pipeline_metrics& pipeline_metrics::operator+=(const pipeline_metrics& a_metrics)
+{
+    for (int i = 0; i < e_number_of_stages; i++) {
+        f_time[i] += a_metrics.f_time[i];
+    }
+    for (int i = 0; i < e_number_of_counters; i++) {
+        f_count[i] += a_metrics.f_count[i];
+    }
+    return *this;
+}
+
+const char* pipeline_metrics::stage_name(stage_t a_stage)
+{
+    static const char* t_names[e_number_of_stages] = {
+        "query", "transfer", "parse", "calibrate", "resample", "serialize"
+    };
+    return t_names[a_stage];
+}
+
+const char* pipeline_metrics::counter_name(counter_t a_counter)
+{
+    static const char* t_names[e_number_of_counters] = {
+        "reads", "queries", "sensors", "rows", "bytes", "points"
+    };
+    return t_names[a_counter];
+}
+
+string pipeline_metrics::to_json(const string& a_indent) const
+{
+    ostringstream os;
+    os << "{" << endl;
+    os << a_indent << "    \"seconds\": { ";
+    for (int i = 0; i < e_number_of_stages; i++) {
+        os << (i ? ", " : "") << "\"" << stage_name(stage_t(i)) << "\": " << f_time[i];
+    }
+    os << " }," << endl;
+    os << a_indent << "    \"counts\": { ";
+    for (int i = 0; i < e_number_of_counters; i++) {
+        os << (i ? ", " : "") << "\"" << counter_name(counter_t(i)) << "\": " << f_count[i];
+    }
+    os << " }" << endl;
+    os << a_indent << "}";
+
+    return os.str();
+}
+
+string pipeline_metrics::to_prometheus(const string& a_prefix) const
+{
+    ostringstream os;
+    os << "# HELP " << a_prefix << "_stage_seconds_total Time spent in each stage of reading." << endl;
+    os << "# TYPE " << a_prefix << "_stage_seconds_total counter" << endl;
+    for (int i = 0; i < e_number_of_stages; i++) {
+        os << a_prefix << "_stage_seconds_total{stage=\"" << stage_name(stage_t(i)) << "\"} " << f_time[i] << endl;
+    }
+    for (int i = 0; i < e_number_of_counters; i++) {
+        string t_name = a_prefix + "_" + counter_name(counter_t(i)) + "_total";
+        os << "# TYPE " << t_name << " counter" << endl;
+        os << t_name << " " << f_count[i] << endl;
+    }
+
+    return os.str();
+}
+
+
+
+metrics_scope::metrics_scope(pipeline_metrics& a_metrics)
+: f_metrics(a_metrics)
+{
+    f_outer = g_current_metrics_scope;
+    g_current_metrics_scope = this;
+}
+
+metrics_scope::~metrics_scope()
+{
+    g_current_metrics_scope = f_outer;
+}
+
+void metrics_scope::add_time(pipeline_metrics::stage_t a_stage, double a_seconds)
+{
+    for (auto t_scope = g_current_metrics_scope; t_scope; t_scope = t_scope->f_outer) {
+        t_scope->f_metrics.add_time(a_stage, a_seconds);
+    }
+}
+
+void metrics_scope::add_count(pipeline_metrics::counter_t a_counter, long a_count)
+{
+    for (auto t_scope = g_current_metrics_scope; t_scope; t_scope = t_scope->f_outer) {
+        t_scope->f_metrics.add_count(a_counter, a_count);
+    }
+}
+
+bool metrics_scope::is_active()
+{
+    return g_current_metrics_scope != nullptr;
+}
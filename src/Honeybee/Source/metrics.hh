@@ -0,0 +1,98 @@
+/*
+ * metrics.hh
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sanshiro Enomoto <sanshiro@uw.edu>
+ */
+
+#ifndef HONEYBEE_METRICS_HH_
+#define HONEYBEE_METRICS_HH_ 1
+
+#include <string>
+#include <chrono>
+
+
+namespace honeybee {
+    using namespace std;
+
+    // Time spent in each stage of a read, and data counters.
+    // Instrumented code reports to all the metrics_scope's active in the current thread;
+    // a caller opens a scope around the work to be attributed:
+    //    pipeline_metrics t_metrics;
+    //    { metrics_scope t_scope(t_metrics); app.read(...); ... }
+    //    cout << t_metrics.to_json();
+    class pipeline_metrics {
+      public:
+        enum stage_t {
+            e_stage_query,      // SQL execution, until the first response
+            e_stage_transfer,   // receiving the response
+            e_stage_parse,      // converting rows into series
+            e_stage_calibrate,
+            e_stage_resample,
+            e_stage_serialize,  // output formatting
+            e_number_of_stages
+        };
+        enum counter_t {
+            e_counter_reads,
+            e_counter_queries,
+            e_counter_sensors,
+            e_counter_rows,
+            e_counter_bytes,    // size of the values received from the data store
+            e_counter_points,   // data points returned by read()
+            e_number_of_counters
+        };
+      public:
+        pipeline_metrics() { clear(); }
+        void clear();
+        void add_time(stage_t a_stage, double a_seconds) { f_time[a_stage] += a_seconds; }
+        void add_count(counter_t a_counter, long a_count) { f_count[a_counter] += a_count; }
+        double get_time(stage_t a_stage) const { return f_time[a_stage]; }
+        long get_count(counter_t a_counter) const { return f_count[a_counter]; }
+        pipeline_metrics& operator+=(const pipeline_metrics& a_metrics);
+        string to_json(const string& a_indent="") const;
+        string to_prometheus(const string& a_prefix="honeybee") const;  // text exposition format
+        static const char* stage_name(stage_t a_stage);
+        static const char* counter_name(counter_t a_counter);
+      protected:
+        double f_time[e_number_of_stages];
+        long f_count[e_number_of_counters];
+    };
+
+
+    class metrics_scope {
+      public:
+        metrics_scope(pipeline_metrics& a_metrics);
+        ~metrics_scope();
+        metrics_scope(const metrics_scope&) = delete;
+        metrics_scope& operator=(const metrics_scope&) = delete;
+        // to the scopes of the current thread //
+        static void add_time(pipeline_metrics::stage_t a_stage, double a_seconds);
+        static void add_count(pipeline_metrics::counter_t a_counter, long a_count);
+        static bool is_active();
+      protected:
+        pipeline_metrics& f_metrics;
+        metrics_scope* f_outer;
+    };
+
+
+    // measures the time from the construction to the destruction (or stop()) //
+    class metrics_span {
+      public:
+        metrics_span(pipeline_metrics::stage_t a_stage): f_stage(a_stage), f_is_running(true) {
+            f_start = std::chrono::steady_clock::now();
+        }
+        ~metrics_span() { stop(); }
+        void stop() {
+            if (f_is_running) {
+                f_is_running = false;
+                metrics_scope::add_time(f_stage, std::chrono::duration<double>(std::chrono::steady_clock::now() - f_start).count());
+            }
+        }
+      protected:
+        pipeline_metrics::stage_t f_stage;
+        bool f_is_running;
+        std::chrono::steady_clock::time_point f_start;
+    };
+
+}
+#endif
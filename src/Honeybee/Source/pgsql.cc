@@ -10,7 +10,12 @@
 #include <iostream>
 #include <string>
 #include <functional>
+#include <algorithm>
 #include <libpq-fe.h>
+#include <cerrno>
+#include <cstdlib>
+#include <poll.h>
+#include "metrics.hh"
 
 using namespace std;
 using namespace honeybee;
@@ -19,7 +24,15 @@ using namespace honeybee;
 pgsql::pgsql(string a_uri)
 : f_uri(a_uri)
 {
-    f_connection = 0;
+    f_number_of_connections = 0;
+    f_max_connections = 1;
+}
+
+pgsql::~pgsql()
+{
+    for (auto t_connection: f_idle_connections) {
+        PQfinish(t_connection);
+    }
 }
 
 void pgsql::set_db(string a_uri)
@@ -27,45 +40,168 @@ void pgsql::set_db(string a_uri)
     f_uri = a_uri;
 }
 
-int pgsql::query(const string& a_sql, handler a_handler, bool a_header_enabled)
+void pgsql::set_max_connections(unsigned a_max_connections)
+{
+    std::lock_guard<std::mutex> t_lock(f_mutex);
+    f_max_connections = std::max(1u, a_max_connections);
+}
+
+pg_conn* pgsql::acquire()
+{
+    std::unique_lock<std::mutex> t_lock(f_mutex);
+    f_connection_released.wait(t_lock, [&]{
+        return ! f_idle_connections.empty() || (f_number_of_connections < f_max_connections);
+    });
+    if (! f_idle_connections.empty()) {
+        pg_conn* t_connection = f_idle_connections.back();
+        f_idle_connections.pop_back();
+        return t_connection;
+    }
+    f_number_of_connections++;
+    if (f_uri.substr(0, 13) != "postgresql://") {
+        f_uri = "postgresql://" + f_uri;
+    }
+    string t_uri = f_uri;
+    t_lock.unlock();
+
+    // connecting takes time; other threads can use the idle connections meanwhile //
+    hINFO(cerr << "connecting to DB (" + t_uri + ")..." << endl);
+    auto t_connection = PQconnectdb(t_uri.c_str());
+    if (PQstatus(t_connection) == CONNECTION_BAD) {
+        string t_message = PQerrorMessage(t_connection);
+        PQfinish(t_connection);
+        release(nullptr, true);
+        throw std::runtime_error(string("DB Connection: ") + t_message);
+    }
+    hINFO(cerr << "    DB connected." << endl);
+    
+    return t_connection;
+}
+
+void pgsql::release(pg_conn* a_connection, bool a_is_broken)
+{
+    {
+        std::lock_guard<std::mutex> t_lock(f_mutex);
+        if (a_is_broken) {
+            f_number_of_connections--;
+        }
+        else {
+            f_idle_connections.push_back(a_connection);
+        }
+    }
+    if (a_is_broken && a_connection) {
+        PQfinish(a_connection);
+    }
+    f_connection_released.notify_one();
+}
+
+pg_result* pgsql::execute(pg_conn* a_connection, const string& a_sql)
 {
-    if (! f_connection) {
-        if (f_uri.substr(0, 13) != "postgresql://") {
-            f_uri = "postgresql://" + f_uri;
+    // sent asynchronously, to tell the server-side execution from the transfer //
+    if (! PQsendQuery(a_connection, a_sql.c_str())) {
+        return nullptr;
+    }
+    struct pollfd t_poll = { PQsocket(a_connection), POLLIN, 0 };
+    metrics_span t_query_span(pipeline_metrics::e_stage_query);
+    while ((poll(&t_poll, 1, -1) < 0) && (errno == EINTR)) {
+        continue;
+    }
+    t_query_span.stop();
+    
+    metrics_span t_transfer_span(pipeline_metrics::e_stage_transfer);
+    pg_result* t_result = nullptr;
+    while (true) {
+        if (! PQconsumeInput(a_connection)) {
+            break;
+        }
+        if (PQisBusy(a_connection)) {
+            while ((poll(&t_poll, 1, -1) < 0) && (errno == EINTR)) {
+                continue;
+            }
+            continue;
+        }
+        pg_result* t_next = PQgetResult(a_connection);
+        if (! t_next) {
+            break;
+        }
+        if (t_result) {
+            PQclear(t_next);  // only one statement is expected
         }
-        hINFO(cerr << "connecting to DB (" + f_uri + ")..." << endl);
-        auto connection = PQconnectdb(f_uri.c_str());
-        if (PQstatus(connection) == CONNECTION_BAD) {
-            throw std::runtime_error(string("DB Connection: ") + PQerrorMessage(connection));
+        else {
+            t_result = t_next;
         }
-        f_connection = connection;
-        hINFO(cerr << "    DB connected." << endl);
     }
     
-    auto* resp = PQexec(f_connection, a_sql.c_str());
+    return t_result;
+}
+
+int pgsql::query(const string& a_sql, handler a_handler, bool a_header_enabled)
+{
+    pg_conn* t_connection = acquire();
+    
+    auto* resp = execute(t_connection, a_sql);
     if (PQresultStatus(resp) != PGRES_TUPLES_OK) {
         PQclear(resp);
-        throw std::runtime_error(string("SQL: ") + PQerrorMessage(f_connection));
+        string t_message = PQerrorMessage(t_connection);
+        // a lost connection is dropped, to be re-opened by the next query //
+        release(t_connection, PQstatus(t_connection) == CONNECTION_BAD);
+        throw std::runtime_error(string("SQL: ") + t_message);
     }
     
     int n = PQntuples(resp);
     int m = PQnfields(resp);
-    if (a_header_enabled) {
-        for (int col = 0; col < m; col++) {
-            a_handler(-1, col, PQfname(resp, col));
+    long t_bytes = 0;
+    metrics_span t_parse_span(pipeline_metrics::e_stage_parse);
+    try {
+        if (a_header_enabled) {
+            for (int col = 0; col < m; col++) {
+                a_handler(-1, col, PQfname(resp, col));
+            }
         }
-    }
-    for (int row = 0; row < n; row++) {
-        for (int col = 0; col < m; col++) {
-            a_handler(row, col, PQgetvalue(resp, row , col));
+        for (int row = 0; row < n; row++) {
+            for (int col = 0; col < m; col++) {
+                a_handler(row, col, PQgetvalue(resp, row , col));
+                t_bytes += PQgetlength(resp, row, col);
+            }
         }
     }
+    catch (...) {
+        PQclear(resp);
+        release(t_connection, false);
+        throw;
+    }
+    
+    t_parse_span.stop();
+    metrics_scope::add_count(pipeline_metrics::e_counter_queries, 1);
+    metrics_scope::add_count(pipeline_metrics::e_counter_rows, n);
+    metrics_scope::add_count(pipeline_metrics::e_counter_bytes, t_bytes);
     
     PQclear(resp);
+    release(t_connection, false);
     
     return n;
 }
 
+long pgsql::command(const string& a_sql)
+{
+    pg_conn* t_connection = acquire();
+    
+    auto* resp = execute(t_connection, a_sql);
+    if ((PQresultStatus(resp) != PGRES_COMMAND_OK) && (PQresultStatus(resp) != PGRES_TUPLES_OK)) {
+        PQclear(resp);
+        string t_message = PQerrorMessage(t_connection);
+        release(t_connection, PQstatus(t_connection) == CONNECTION_BAD);
+        throw std::runtime_error(string("SQL: ") + t_message);
+    }
+    long t_count = atol(PQcmdTuples(resp));
+    metrics_scope::add_count(pipeline_metrics::e_counter_queries, 1);
+    
+    PQclear(resp);
+    release(t_connection, false);
+    
+    return t_count;
+}
+
 vector<string> pgsql::get_table_list()
 {
     vector<string> t_tables;
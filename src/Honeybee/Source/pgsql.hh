@@ -11,7 +11,10 @@
 #include <string>
 #include <vector>
 #include <functional>
+#include <mutex>
+#include <condition_variable>
 struct pg_conn;
+struct pg_result;
 
 namespace honeybee {
     using namespace std;
@@ -20,13 +23,26 @@ namespace honeybee {
         using handler = function<void(int, int, const char*)>;
       public:
         pgsql(string a_uri="");
+        ~pgsql();
+        pgsql(const pgsql&) = delete;
+        pgsql& operator=(const pgsql&) = delete;
         void set_db(string a_uri);
+        void set_max_connections(unsigned a_max_connections);  // for concurrent queries from threads
         int query(const string& a_sql, handler a_handler, bool a_header_enabled = false);
+        long command(const string& a_sql);  // for statements without rows (CREATE etc); returns the affected rows
         vector<string> get_table_list();
         vector<string> get_column_list(const string& a_table_name);
+      protected:
+        pg_conn* acquire();
+        void release(pg_conn* a_connection, bool a_is_broken);
+        pg_result* execute(pg_conn* a_connection, const string& a_sql);
       protected:
         string f_uri;
-        pg_conn* f_connection;
+        // connections are opened on demand up to f_max_connections, and reused afterwards //
+        vector<pg_conn*> f_idle_connections;
+        unsigned f_number_of_connections, f_max_connections;
+        std::mutex f_mutex;  // a connection can be shared by data sources in different threads
+        std::condition_variable f_connection_released;
     };
 }
 
@@ -0,0 +1,316 @@
+/*
+ * rollup.cc
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sanshiro Enomoto <sanshiro@uw.edu>
+ */
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include "utils.hh"
+#include "pgsql.hh"
+#include "rollup.hh"
+
+using namespace std;
+using namespace honeybee;
+
+
+namespace {
+    string sql_time(double a_time)
+    {
+        // the same form as the data queries, which works for timestamp with and without time zone //
+        return "'" + datetime((long) a_time).as_string() + "Z'";
+    }
+    
+    string sql_integer(double a_value)
+    {
+        return std::to_string((long long) a_value);
+    }
+}
+
+
+dripline_rollup::dripline_rollup(shared_ptr<pgsql> a_pgsql, const string& a_sensorname_column)
+: f_pgsql(a_pgsql), f_sensorname_column(a_sensorname_column)
+{
+}
+
+string dripline_rollup::get_sensorname_column()
+{
+    if (f_sensorname_column.empty()) {
+        for (auto& f: f_pgsql->get_column_list("numeric_data")) {
+            if ((f == "endpoint_name") || (f == "sensor_name")) {
+                f_sensorname_column = f;
+                break;
+            }
+        }
+        if (f_sensorname_column.empty()) {
+            throw std::runtime_error("unable to identify sensor-name column in Dripline Table");
+        }
+    }
+    
+    return f_sensorname_column;
+}
+
+bool dripline_rollup::is_available()
+{
+    bool t_is_available = false;
+    auto t_handler = [&](int a_row, int a_col, const char* a_value) {
+        t_is_available = (string(a_value) == "t");
+    };
+    f_pgsql->query("SELECT to_regclass('hb_rollup_state') IS NOT NULL AND to_regclass('hb_rollup') IS NOT NULL", t_handler);
+
+    return t_is_available;
+}
+
+void dripline_rollup::create()
+{
+    f_pgsql->command(string("")
+        + "CREATE TABLE IF NOT EXISTS hb_rollup ("
+        + "  endpoint_name text NOT NULL, "
+        + "  resolution integer NOT NULL, "
+        + "  bucket bigint NOT NULL, "
+        + "  count bigint NOT NULL, "
+        + "  sum double precision, sumsq double precision, "
+        + "  min double precision, max double precision, "
+        + "  first double precision, last double precision, "
+        + "  PRIMARY KEY (resolution, endpoint_name, bucket)"
+        + ")"
+    );
+    f_pgsql->command(string("")
+        + "CREATE TABLE IF NOT EXISTS hb_rollup_state ("
+        + "  resolution integer PRIMARY KEY, "
+        + "  since double precision NOT NULL, "
+        + "  until double precision NOT NULL"
+        + ")"
+    );
+}
+
+void dripline_rollup::drop()
+{
+    f_pgsql->command("DROP TABLE IF EXISTS hb_rollup_state");
+    f_pgsql->command("DROP TABLE IF EXISTS hb_rollup");
+}
+
+vector<dripline_rollup::coverage> dripline_rollup::get_coverage()
+{
+    return this->query_coverage("SELECT resolution, since, until FROM hb_rollup_state ORDER BY resolution");
+}
+
+vector<dripline_rollup::coverage> dripline_rollup::get_status()
+{
+    return this->query_coverage(string("")
+        + "SELECT"
+        + "  s.resolution, s.since, s.until, "
+        + "  (SELECT count(*) FROM hb_rollup AS r WHERE r.resolution = s.resolution) "
+        + "FROM"
+        + "  hb_rollup_state AS s "
+        + "ORDER BY"
+        + "  s.resolution"
+    );
+}
+
+vector<dripline_rollup::coverage> dripline_rollup::query_coverage(const string& a_sql)
+{
+    vector<coverage> t_coverage_list;
+    auto t_handler = [&](int a_row, int a_col, const char* a_value) {
+        if (a_col == 0) {
+            t_coverage_list.push_back({(unsigned) atol(a_value), 0, 0, -1});
+        }
+        else if (a_col == 1) {
+            t_coverage_list.back().f_since = stod(a_value);
+        }
+        else if (a_col == 2) {
+            t_coverage_list.back().f_until = stod(a_value);
+        }
+        else {
+            t_coverage_list.back().f_number_of_buckets = atol(a_value);
+        }
+    };
+    f_pgsql->query(a_sql, t_handler);
+
+    return t_coverage_list;
+}
+
+long dripline_rollup::update(unsigned a_resolution, double a_from, double a_to)
+{
+    if (a_resolution == 0) {
+        throw std::runtime_error("rollup: resolution must be a positive number of seconds");
+    }
+    const double R = a_resolution;
+    string t_column = this->get_sensorname_column();
+    vector<coverage> t_coverage_list = this->get_coverage();
+    
+    // range, in complete buckets //
+    double t_since = -1, t_begin = -1; {
+        for (const auto& t_coverage: t_coverage_list) {
+            if (t_coverage.f_resolution == a_resolution) {
+                t_since = t_coverage.f_since;
+                t_begin = t_coverage.f_until;
+            }
+        }
+        if ((a_from >= 0) && ((t_begin < 0) || (a_from < t_begin))) {
+            t_begin = a_from;
+        }
+        if (t_begin < 0) {
+            auto t_handler = [&](int a_row, int a_col, const char* a_value) {
+                if (*a_value) {
+                    t_begin = stod(a_value);
+                }
+            };
+            f_pgsql->query("SELECT floor(extract(epoch FROM min(timestamp))) FROM numeric_data", t_handler);
+        }
+        if (t_begin < 0) {
+            return 0;  // no data
+        }
+        t_begin = floor(t_begin / R) * R;
+    }
+    double t_end = floor(((a_to >= 0) ? a_to : (double) time(NULL)) / R) * R;
+    if ((t_since >= 0) && (t_begin < t_since) && (t_end < t_since)) {
+        // the coverage is a single range; a gap to it would be recorded as covered //
+        t_end = t_since;
+    }
+    
+    // In chunks of about a day, each committed with the coverage, so that an interrupted update can be resumed.
+    // The part before the covered range is rolled up backwards, for each chunk to extend the range without a gap.
+    const double t_chunk = ceil(86400 / R) * R;
+    const double t_split = (t_since >= 0) ? std::min(std::max(t_begin, t_since), t_end) : t_begin;
+    vector<pair<double, double>> t_chunk_list;
+    for (double t_start = t_split; t_start < t_end; t_start += t_chunk) {
+        t_chunk_list.emplace_back(t_start, std::min(t_start + t_chunk, t_end));
+    }
+    for (double t_stop = t_split; t_stop > t_begin; t_stop -= t_chunk) {
+        t_chunk_list.emplace_back(std::max(t_stop - t_chunk, t_begin), t_stop);
+    }
+    
+    long t_number_of_buckets = 0;
+    for (const auto& t_range: t_chunk_list) {
+        double t_start = t_range.first, t_stop = t_range.second;
+        
+        // a finer rollup covering the chunk is used instead of the raw data //
+        unsigned t_source_resolution = 0;
+        for (const auto& t_coverage: t_coverage_list) {
+            unsigned r = t_coverage.f_resolution;
+            if ((r < a_resolution) && (a_resolution % r == 0) && (t_coverage.f_since <= t_start) && (t_coverage.f_until >= t_stop)) {
+                t_source_resolution = std::max(t_source_resolution, r);
+            }
+        }
+        
+        string t_select;
+        if (t_source_resolution > 0) {
+            t_select = (string("")
+                + "SELECT"
+                + "  endpoint_name, " + sql_integer(R) + ", "
+                + "  floor(bucket::double precision/" + sql_integer(R) + ")::bigint*" + sql_integer(R) + " AS t_bucket, "
+                + "  sum(count), sum(sum), sum(sumsq), min(min), max(max), "
+                + "  (array_agg(first ORDER BY bucket ASC))[1], (array_agg(last ORDER BY bucket DESC))[1] "
+                + "FROM"
+                + "  hb_rollup "
+                + "WHERE"
+                + "  resolution = " + std::to_string(t_source_resolution) + " "
+                + "  AND bucket >= " + sql_integer(t_start) + " AND bucket < " + sql_integer(t_stop) + " "
+                + "GROUP BY"
+                + "  endpoint_name, t_bucket"
+            );
+        }
+        else {
+            string t_raw = (string("")
+                + "SELECT"
+                + "  " + t_column + " AS t_name, timestamp AS t_time, value_raw::double precision AS t_value "
+                + "FROM"
+                + "  numeric_data "
+                + "WHERE"
+                + "  timestamp >= " + sql_time(t_start) + " AND timestamp < " + sql_time(t_stop) + " "
+                + "  AND value_raw IS NOT NULL"
+            );
+            t_select = (string("")
+                + "SELECT"
+                + "  t_name, " + sql_integer(R) + ", "
+                + "  (floor(extract(epoch FROM t_time)/" + sql_integer(R) + ")*" + sql_integer(R) + ")::bigint AS t_bucket, "
+                + "  count(*), sum(t_value), sum(t_value*t_value), min(t_value), max(t_value), "
+                + "  (array_agg(t_value ORDER BY t_time ASC))[1], (array_agg(t_value ORDER BY t_time DESC))[1] "
+                + "FROM"
+                + "  (" + t_raw + ") AS t_raw "
+                + "WHERE"
+                + "  t_value <> 'NaN'::double precision "
+                + "GROUP BY"
+                + "  t_name, t_bucket"
+            );
+        }
+
+        // buckets and coverage in one statement, i.e., in one transaction; //
+        // the coverage is extended only by a chunk touching it            //
+        string t_sql = (string("")
+            + "WITH t_rolled AS ("
+            + "  INSERT INTO hb_rollup (endpoint_name, resolution, bucket, count, sum, sumsq, min, max, first, last) "
+            + "  " + t_select + " "
+            + "  ON CONFLICT (resolution, endpoint_name, bucket) DO UPDATE SET"
+            + "    count = EXCLUDED.count, sum = EXCLUDED.sum, sumsq = EXCLUDED.sumsq, min = EXCLUDED.min, max = EXCLUDED.max, "
+            + "    first = EXCLUDED.first, last = EXCLUDED.last "
+            + "  RETURNING 1"
+            + "), t_state AS ("
+            + "  INSERT INTO hb_rollup_state (resolution, since, until) "
+            + "  VALUES (" + sql_integer(R) + ", " + sql_integer(t_start) + ", " + sql_integer(t_stop) + ") "
+            + "  ON CONFLICT (resolution) DO UPDATE SET"
+            + "    since = LEAST(hb_rollup_state.since, EXCLUDED.since), until = GREATEST(hb_rollup_state.until, EXCLUDED.until) "
+            + "  WHERE"
+            + "    EXCLUDED.since <= hb_rollup_state.until AND EXCLUDED.until >= hb_rollup_state.since"
+            + ") "
+            + "SELECT count(*) FROM t_rolled"
+        );
+        hINFO(cerr << "SQL: " << endl);
+        hINFO(cerr << "    " << t_sql << endl);
+        
+        long t_count = 0;
+        auto t_handler = [&](int a_row, int a_col, const char* a_value) {
+            t_count = atol(a_value);
+        };
+        f_pgsql->query(t_sql, t_handler);
+        t_number_of_buckets += t_count;
+        
+        hINFO(cerr << "Rollup " << a_resolution << "s: " << datetime((long) t_start).as_string() << " - " << datetime((long) t_stop).as_string());
+        hINFO(cerr << " from " << (t_source_resolution ? std::to_string(t_source_resolution) + "s rollup" : string("raw data")) << ", " << t_count << " buckets" << endl);
+    }
+
+    return t_number_of_buckets;
+}
+
+void dripline_rollup::read(unsigned a_resolution, const string& a_endpoint_list, double a_from, double a_to, std::function<void(const bucket&)> a_handler)
+{
+    string t_sql = (string("")
+        + "SELECT"
+        + "  bucket, endpoint_name, count, sum, sumsq, min, max, first, last "
+        + "FROM"
+        + "  hb_rollup "
+        + "WHERE"
+        + "  resolution = " + std::to_string(a_resolution) + " "
+        + "  AND endpoint_name IN (" + a_endpoint_list + ") "
+        + "  AND bucket >= " + sql_integer(floor(a_from)) + " AND bucket < " + sql_integer(ceil(a_to)) + " "
+        + "ORDER BY"
+        + "  bucket ASC"
+    );
+    hINFO(cerr << "SQL: " << endl);
+    hINFO(cerr << "    " << t_sql << endl);
+
+    bucket t_bucket;
+    string t_endpoint;
+    auto t_handler = [&](int a_row, int a_col, const char* a_value) {
+        switch (a_col) {
+          case 0: t_bucket.f_time = stod(a_value); break;
+          case 1: t_endpoint = a_value; t_bucket.f_endpoint = t_endpoint.c_str(); break;
+          case 2: t_bucket.f_count = stod(a_value); break;
+          case 3: t_bucket.f_sum = stod(a_value); break;
+          case 4: t_bucket.f_sumsq = stod(a_value); break;
+          case 5: t_bucket.f_min = stod(a_value); break;
+          case 6: t_bucket.f_max = stod(a_value); break;
+          case 7: t_bucket.f_first = stod(a_value); break;
+          case 8: t_bucket.f_last = stod(a_value); a_handler(t_bucket); break;
+        }
+    };
+    f_pgsql->query(t_sql, t_handler);
+}
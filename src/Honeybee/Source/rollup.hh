@@ -0,0 +1,62 @@
+/*
+ * rollup.hh
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sanshiro Enomoto <sanshiro@uw.edu>
+ */
+
+#ifndef HONEYBEE_ROLLUP_HH_
+#define HONEYBEE_ROLLUP_HH_ 1
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include "pgsql.hh"
+
+
+namespace honeybee {
+    using namespace std;
+
+    // Precomputed aggregates of the Dripline numeric_data, in side tables of the same DB:
+    //   hb_rollup (endpoint_name, resolution, bucket, count, sum, sumsq, min, max, first, last)
+    //   hb_rollup_state (resolution, since, until): the time range rolled up, in UNIX time
+    // Buckets are [bucket, bucket+resolution), aligned to multiples of the resolution (in seconds).
+    // NULL and NaN values are not included, as in the reducers of series.
+    class dripline_rollup {
+      public:
+        struct coverage {
+            unsigned f_resolution;
+            double f_since, f_until;
+            long f_number_of_buckets;  // only by get_status()
+        };
+        struct bucket {
+            double f_time;  // start
+            const char* f_endpoint;
+            double f_count, f_sum, f_sumsq, f_min, f_max, f_first, f_last;
+        };
+      public:
+        // the sensor-name column of numeric_data is found in the DB if not given //
+        dripline_rollup(shared_ptr<pgsql> a_pgsql, const string& a_sensorname_column="");
+        bool is_available();  // true if the tables exist
+        void create();
+        void drop();
+        // Rolls up the complete buckets before a_to (default: now), from the end of the current range;
+        // a_from (re)builds from that time instead, e.g., for late data. The range rolled up is kept
+        // contiguous: a run ending before the current range is extended up to it. Finer resolutions dividing
+        // this one are used as the input where they cover the range. Returns the number of buckets written.
+        long update(unsigned a_resolution, double a_from=-1, double a_to=-1);
+        vector<coverage> get_coverage();
+        vector<coverage> get_status();  // with the number of buckets, which takes a table scan
+        // buckets of the given end-points (quoted and comma-separated, as in SQL) in [a_from, a_to) //
+        void read(unsigned a_resolution, const string& a_endpoint_list, double a_from, double a_to, std::function<void(const bucket&)> a_handler);
+      protected:
+        string get_sensorname_column();
+        vector<coverage> query_coverage(const string& a_sql);
+      protected:
+        shared_ptr<pgsql> f_pgsql;
+        string f_sensorname_column;
+    };
+
+}
+#endif
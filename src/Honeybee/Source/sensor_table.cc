@@ -11,7 +11,15 @@
 #include <iomanip>
 #include <set>
 #include <algorithm>
+#include <iterator>
+#include <mutex>
+#include <atomic>
+#include <stdexcept>
+#include <unordered_map>
 #include <cmath>
+#include <ctime>
+#include <regex>
+#include <fnmatch.h>
 #include <kebap/Kebap.h>
 #include <tabree/KTreeFile.h>
 #include "utils.hh"
@@ -22,6 +30,89 @@ using namespace honeybee;
 
 int sensor_table::f_unique_sequence = 0;
 
+
+namespace {
+    // names are stored in chunks that are never moved or freed; a token is readable //
+    // without the lock once the published size covers it                            //
+    struct name_token_storage {
+        enum { e_chunk_bits = 12, e_chunk_size = 1 << e_chunk_bits, e_max_chunks = 1 << 14 };
+        std::mutex f_mutex;  // for intern()
+        unordered_map<string, int> f_ids;
+        std::atomic<string*> f_chunks[e_max_chunks];
+        std::atomic<int> f_size;
+        name_token_storage(): f_size(0) {
+            for (auto& t_chunk: f_chunks) {
+                t_chunk.store(nullptr, std::memory_order_relaxed);
+            }
+            append("");  // e_empty
+        }
+        int append(const string& a_name) {
+            int t_token = f_size.load(std::memory_order_relaxed);
+            if (t_token >= e_chunk_size * e_max_chunks) {
+                throw std::length_error("name_token_table: too many names");
+            }
+            string* t_chunk = f_chunks[t_token >> e_chunk_bits].load(std::memory_order_relaxed);
+            if (t_chunk == nullptr) {
+                t_chunk = new string[e_chunk_size];
+                f_chunks[t_token >> e_chunk_bits].store(t_chunk, std::memory_order_release);
+            }
+            t_chunk[t_token & (e_chunk_size - 1)] = a_name;
+            f_ids.emplace(a_name, t_token);
+            f_size.store(t_token + 1, std::memory_order_release);
+            return t_token;
+        }
+    };
+    
+    name_token_storage& name_tokens()
+    {
+        static name_token_storage t_storage;
+        return t_storage;
+    }
+}
+
+int name_token_table::intern(const string& a_name)
+{
+    auto& t_storage = name_tokens();
+    std::lock_guard<std::mutex> t_lock(t_storage.f_mutex);
+    auto iter = t_storage.f_ids.find(a_name);
+    if (iter != t_storage.f_ids.end()) {
+        return iter->second;
+    }
+    
+    return t_storage.append(a_name);
+}
+
+int name_token_table::find(const string& a_name)
+{
+    auto& t_storage = name_tokens();
+    std::lock_guard<std::mutex> t_lock(t_storage.f_mutex);
+    auto iter = t_storage.f_ids.find(a_name);
+    
+    return (iter != t_storage.f_ids.end()) ? iter->second : int(e_unknown);
+}
+
+const string& name_token_table::name_of(int a_token)
+{
+    static const string t_unknown;
+    auto& t_storage = name_tokens();
+    if ((a_token < 0) || (a_token >= t_storage.f_size.load(std::memory_order_acquire))) {
+        return t_unknown;
+    }
+    const string* t_chunk = t_storage.f_chunks[a_token >> name_token_storage::e_chunk_bits].load(std::memory_order_acquire);
+    
+    return t_chunk[a_token & (name_token_storage::e_chunk_size - 1)];
+}
+
+bool sensor::has_calibration_versions() const
+{
+    for (const auto& t_version: f_versions) {
+        if (t_version.f_calibration != f_calibration) {
+            return true;
+        }
+    }
+    return false;
+}
+
 string sensor::to_json(vector<string> a_field_list, const std::string& a_delimiter) const
 {
     if (a_field_list.empty()) {
@@ -30,6 +121,9 @@ string sensor::to_json(vector<string> a_field_list, const std::string& a_delimit
     
     ostringstream os;
     string delim = " ";
+    auto write_time = [&](double t) {
+        if (std::isinf(t)) os << "null"; else os << "\"" << datetime(long(t)).as_string() << "\"";
+    };
     
     os << "{";
     for (auto& f: a_field_list) {
@@ -45,6 +139,20 @@ string sensor::to_json(vector<string> a_field_list, const std::string& a_delimit
         }
         else if ((f.find("calibration") != string::npos)  && ! f_calibration.empty()) {
             os << delim << "\"default_calibration\": \"" << f_calibration << "\"";
+            if (! f_calibration_cache.empty()) {
+                os << ", \"calibration_cache\": \"" << f_calibration_cache << "\"";
+            }
+            if (has_calibration_versions()) {
+                string t_version_delim = " ";
+                os << ", \"calibration_versions\": [";
+                for (const auto& t_version: f_versions) {
+                    os << t_version_delim << "{ \"from\": "; write_time(t_version.f_start);
+                    os << ", \"to\": "; write_time(t_version.f_stop);
+                    os << ", \"calibration\": \"" << t_version.f_calibration << "\" }";
+                    t_version_delim = ", ";
+                }
+                os << " ]";
+            }
         }
         else if ((f.substr(0,3) == "opt") && ! f_options.empty()) {
             bool t_is_first_opt = true;
@@ -56,6 +164,25 @@ string sensor::to_json(vector<string> a_field_list, const std::string& a_delimit
             }
             os << " }";
         }
+        else if ((f == "versions") && ! f_versions.empty()) {
+            string t_version_delim = " ";
+            os << delim << "\"versions\": [";
+            for (const auto& t_version: f_versions) {
+                os << t_version_delim << "{ \"from\": "; write_time(t_version.f_start);
+                os << ", \"to\": "; write_time(t_version.f_stop);
+                os << ", \"calibration\": \"" << t_version.f_calibration << "\"";
+                os << ", \"options\": {";
+                bool t_is_first_opt = true;
+                for (auto& t_opt: t_version.f_options) {
+                    os << (t_is_first_opt ? " " : ", ");
+                    os << "\"" << t_opt.first << "\": \"" << t_opt.second << "\"";
+                    t_is_first_opt = false;
+                }
+                os << " } }";
+                t_version_delim = ", ";
+            }
+            os << " ]";
+        }
         delim = ", ";
     }
     os << " }";
@@ -64,23 +191,123 @@ string sensor::to_json(vector<string> a_field_list, const std::string& a_delimit
 }
 
 
+vector<int> sensor_table::reverse_key(const name_chain& a_name)
+{
+    // same identity as the joined string: empty nodes are collapsed, but a leading one leaves a separator //
+    const auto& t_tokens = a_name.get_tokens();
+    vector<int> t_key;
+    for (int t_token: t_tokens) {
+        if (t_token != name_token_table::e_empty) {
+            t_key.push_back(t_token);
+        }
+    }
+    if (! t_key.empty() && (t_tokens.front() == name_token_table::e_empty)) {
+        t_key.insert(t_key.begin(), name_token_table::e_empty);
+    }
+    
+    return t_key;
+}
+
+void sensor_table::add(const sensor& a_sensor)
+{
+    int t_number = a_sensor.get_number();
+    
+    auto t_previous = f_table.find(t_number);
+    if (t_previous != f_table.end()) {
+        if (t_previous->second.get_name() == a_sensor.get_name()) {
+            // only options etc are updated; the name indices stay as they are //
+            t_previous->second = a_sensor;
+            return;
+        }
+        for (int t_token: t_previous->second.get_name().get_tokens()) {
+            auto& t_postings = f_node_index[t_token];
+            auto iter = lower_bound(t_postings.begin(), t_postings.end(), t_number);
+            if ((iter != t_postings.end()) && (*iter == t_number)) {
+                t_postings.erase(iter);
+            }
+        }
+    }
+    
+    f_table[t_number] = a_sensor;
+    f_reverse_table[reverse_key(a_sensor.get_name())] = t_number;
+    if (t_number >= 0x10000000 + f_unique_sequence) {
+        // numbers given elsewhere (e.g., restored from a snapshot) //
+        f_unique_sequence = t_number - 0x10000000 + 1;
+    }
+    
+    for (int t_token: a_sensor.get_name().get_tokens()) {
+        if (t_token >= (int) f_node_index.size()) {
+            f_node_index.resize(t_token + 1);
+        }
+        auto& t_postings = f_node_index[t_token];
+        auto iter = lower_bound(t_postings.begin(), t_postings.end(), t_number);
+        if ((iter == t_postings.end()) || (*iter != t_number)) {
+            t_postings.insert(iter, t_number);
+        }
+    }
+}
+
 vector<int> sensor_table::find_like(const name_chain& a_chain) const
 {
-    const auto& t_pattern = a_chain.get_chain();
+    const auto& t_pattern = a_chain.get_tokens();
     vector<int> t_matches;
     
-    for (const auto& t_sensor: f_table) {
+    if (t_pattern.empty()) {
+        for (const auto& t_sensor: f_table) {
+            t_matches.push_back(t_sensor.first);
+        }
+        return t_matches;
+    }
+
+    // candidates: sensors having all the pattern nodes, from the shortest posting list //
+    vector<const vector<int>*> t_posting_lists;
+    for (int t_token: t_pattern) {
+        if ((t_token < 0) || (t_token >= (int) f_node_index.size()) || f_node_index[t_token].empty()) {
+            return t_matches;
+        }
+        t_posting_lists.push_back(&f_node_index[t_token]);
+    }
+    sort(
+        t_posting_lists.begin(), t_posting_lists.end(),
+        [](const vector<int>* a, const vector<int>* b) { return a->size() < b->size(); }
+    );
+    vector<int> t_candidates = *t_posting_lists.front(), t_intersection;
+    if (t_pattern.size() == 1) {
+        return t_candidates;
+    }
+    for (unsigned k = 1; (k < t_posting_lists.size()) && ! t_candidates.empty(); k++) {
+        const auto& t_postings = *t_posting_lists[k];
+        t_intersection.clear();
+        if (t_candidates.size() * 16 < t_postings.size()) {
+            for (int t_number: t_candidates) {
+                if (binary_search(t_postings.begin(), t_postings.end(), t_number)) {
+                    t_intersection.push_back(t_number);
+                }
+            }
+        }
+        else {
+            set_intersection(
+                t_candidates.begin(), t_candidates.end(),
+                t_postings.begin(), t_postings.end(),
+                back_inserter(t_intersection)
+            );
+        }
+        t_candidates.swap(t_intersection);
+    }
+
+    // the pattern nodes must appear in order //
+    for (int t_number: t_candidates) {
         auto iter = t_pattern.begin();
-        for (const string& node: t_sensor.second.get_name().get_chain()) {
+        for (int t_token: this->operator[](t_number).get_name().get_tokens()) {
             if (iter == t_pattern.end()) {
                 break;
             }
-            if (node == *iter) {
+            if (t_token == *iter) {
                 iter++;
             }
         }
         if (iter == t_pattern.end()) {
-            t_matches.push_back(t_sensor.first);
+            t_matches.push_back(t_number);
         }
     }
     
@@ -107,11 +334,155 @@ int sensor_table::find_one_like(const name_chain& a_chain) const
 
 
 
+sensor_pattern::sensor_pattern(const string& a_pattern, const string& a_delimiters, const string& a_joint)
+: f_text(a_pattern), f_joint(a_joint)
+{
+    if (a_pattern.substr(0, 3) == "re:") {
+        f_regex = make_shared<regex>(a_pattern.substr(3), regex::ECMAScript | regex::optimize);
+        return;
+    }
+
+    // split at the first delimiter found in the pattern, except inside brackets ("[0-9]" etc) //
+    auto is_outside_brackets = [&](size_t a_pos) {
+        int t_depth = 0;
+        for (size_t i = 0; i < a_pos; i++) {
+            if (a_pattern[i] == '[') t_depth = 1;
+            else if (a_pattern[i] == ']') t_depth = 0;
+        }
+        return t_depth == 0;
+    };
+    char t_sep = 0;
+    for (char t_delimiter: a_delimiters) {
+        for (size_t t_pos = a_pattern.find(t_delimiter); t_pos != string::npos; t_pos = a_pattern.find(t_delimiter, t_pos+1)) {
+            if (is_outside_brackets(t_pos)) {
+                t_sep = t_delimiter;
+                break;
+            }
+        }
+        if (t_sep) {
+            break;
+        }
+    }
+    
+    string t_node;
+    for (size_t i = 0; i <= a_pattern.size(); i++) {
+        if ((i == a_pattern.size()) || ((a_pattern[i] == t_sep) && is_outside_brackets(i))) {
+            if (! t_node.empty()) {
+                f_node_patterns.push_back(t_node);
+            }
+            t_node.clear();
+        }
+        else {
+            t_node += a_pattern[i];
+        }
+    }
+}
+
+bool sensor_pattern::is_pattern(const string& a_text)
+{
+    return (a_text.substr(0, 3) == "re:") || (a_text.find_first_of("*?[") != string::npos);
+}
+
+vector<int> sensor_table::find_matching(const sensor_pattern& a_pattern) const
+{
+    vector<int> t_matches;
+    
+    if (a_pattern.f_regex) {
+        for (const auto& t_entry: f_table) {
+            if (regex_search(t_entry.second.get_name().join(a_pattern.f_joint), *a_pattern.f_regex)) {
+                t_matches.push_back(t_entry.first);
+            }
+        }
+        return t_matches;
+    }
+    if (a_pattern.f_node_patterns.empty()) {
+        return find_like({{}});
+    }
+
+    // each node pattern is tested on the distinct name tokens, not on every sensor; //
+    // the candidates are the sensors having a matched token for all the nodes        //
+    vector<vector<char>> t_matched_tokens;
+    vector<int> t_candidates, t_node_sensors, t_intersection;
+    for (const string& t_node_pattern: a_pattern.f_node_patterns) {
+        vector<char> t_is_matched(f_node_index.size(), 0);
+        t_node_sensors.clear();
+        for (unsigned t_token = 0; t_token < f_node_index.size(); t_token++) {
+            const auto& t_postings = f_node_index[t_token];
+            if (t_postings.empty()) {
+                continue;
+            }
+            if (fnmatch(t_node_pattern.c_str(), name_token_table::name_of(t_token).c_str(), 0) == 0) {
+                t_is_matched[t_token] = 1;
+                t_node_sensors.insert(t_node_sensors.end(), t_postings.begin(), t_postings.end());
+            }
+        }
+        sort(t_node_sensors.begin(), t_node_sensors.end());
+        t_node_sensors.erase(unique(t_node_sensors.begin(), t_node_sensors.end()), t_node_sensors.end());
+        if (t_matched_tokens.empty()) {
+            t_candidates.swap(t_node_sensors);
+        }
+        else {
+            t_intersection.clear();
+            set_intersection(
+                t_candidates.begin(), t_candidates.end(),
+                t_node_sensors.begin(), t_node_sensors.end(),
+                back_inserter(t_intersection)
+            );
+            t_candidates.swap(t_intersection);
+        }
+        t_matched_tokens.push_back(std::move(t_is_matched));
+        if (t_candidates.empty()) {
+            return t_matches;
+        }
+    }
+
+    // the node patterns must match in order //
+    for (int t_number: t_candidates) {
+        unsigned k = 0;
+        for (int t_token: this->operator[](t_number).get_name().get_tokens()) {
+            if (k == t_matched_tokens.size()) {
+                break;
+            }
+            if (t_matched_tokens[k][t_token]) {
+                k++;
+            }
+        }
+        if (k == t_matched_tokens.size()) {
+            t_matches.push_back(t_number);
+        }
+    }
+
+    return t_matches;
+}
+
+
+
 void sensor_config_by_file::set_variables(const sensor_config_by_file::variables& a_variables)
 {
     f_variables.insert(f_variables.end(), a_variables.begin(), a_variables.end());
 }
 
+static double timestamp_of_date(long a_date)
+{
+    // a_date: YYYYMMDD, as used in the "date" variable //
+    struct tm tm = {};
+    tm.tm_year = a_date / 10000 - 1900;
+    tm.tm_mon = (a_date / 100) % 100 - 1;
+    tm.tm_mday = a_date % 100;
+    if ((tm.tm_year < 0) || (tm.tm_mon < 0) || (tm.tm_mon > 11) || (tm.tm_mday < 1) || (tm.tm_mday > 31)) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    return timegm(&tm);
+}
+
+static long date_of_timestamp(double a_timestamp)
+{
+    time_t t = a_timestamp;
+    struct tm tm;
+    gmtime_r(&t, &tm);
+    return (tm.tm_year + 1900) * 10000L + (tm.tm_mon + 1) * 100L + tm.tm_mday;
+}
+
 void sensor_config_by_file::load(sensor_table& a_table, const string& a_filename)
 {
     tabree::KTree t_tree;
@@ -123,8 +494,21 @@ void sensor_config_by_file::load(sensor_table& a_table, const string& a_filename
         return;
     }
 
+    f_current_time = std::numeric_limits<double>::quiet_NaN();
+    vector<string> t_variable_names;
+    for (const auto& var: f_variables) {
+        t_variable_names.push_back(var.first);
+        if (var.first == "date") {
+            f_current_time = timestamp_of_date(var.second.AsLong());
+        }
+    }
+    f_variable_set = make_shared<kebap::KPVariableSet>(t_variable_names);
+    f_guard_cache.clear();
+    
     context t_context;
     load_layer(a_table, t_tree["sensor_table"], t_context);
+    
+    attach_versions(a_table);
 }
 
 void sensor_config_by_file::load_layer(sensor_table& a_table, const tabree::KTree& a_node, sensor_config_by_file::context a_context)
@@ -159,23 +543,35 @@ void sensor_config_by_file::load_layer(sensor_table& a_table, const tabree::KTre
             string t_condition = t_node["valid_if"].Or("");
             
             // check guard conditions //
+            // date-dependent guards are evaluated for the entire time span, to keep calibration versions //
+            struct validity { double f_from, f_to; bool f_is_current; };
+            vector<validity> t_validity_list = {{a_context.f_valid_from, a_context.f_valid_to, a_context.f_is_current}};
             if (! t_condition.empty()) {
-                kebap::KPEvaluator f(t_condition);
-                for (const auto& var: f_variables) {
-                    f[var.first] = var.second;
+                const guard& t_guard = evaluate_guard(t_condition);
+                if (! t_guard.f_error.empty()) {
+                    cerr << "ERROR: " << t_guard.f_error << ": " << t_node.NodePath() << endl;
                 }
-                try {
-                    if (! f(0)) {  //... TODO: implement evaluator with no parameter
-                        continue;
+                if (t_guard.f_is_date_dependent) {
+                    t_validity_list.clear();
+                    for (const auto& t_interval: t_guard.f_intervals) {
+                        double t_from = std::max(t_interval.first, a_context.f_valid_from);
+                        double t_to = std::min(t_interval.second, a_context.f_valid_to);
+                        if (t_from < t_to) {
+                            bool t_is_current = a_context.f_is_current && (t_from <= f_current_time) && (f_current_time < t_to);
+                            t_validity_list.push_back({t_from, t_to, t_is_current});
+                        }
                     }
                 }
-                catch (kebap::KPException &e) {
-                    cerr << "ERROR: " << e.what() << ": " << t_node.NodePath() << endl;
+                else if (! t_guard.f_value) {
+                    continue;
                 }
             }
             
-            for (int j = 0; j < std::max<int>(1, t_array_length); j++) {
+            for (const auto& t_validity: t_validity_list) for (int j = 0; j < std::max<int>(1, t_array_length); j++) {
                 auto t_context = a_context;
+                t_context.f_valid_from = t_validity.f_from;
+                t_context.f_valid_to = t_validity.f_to;
+                t_context.f_is_current = t_validity.f_is_current;
                 t_context.f_name.push_front(append_index(t_name, t_array_length, j));
                 t_context.f_label.push_front(append_index(t_label, t_array_length, j));
                 for (const auto& t_key: t_node.KeyList()) {
@@ -195,18 +591,28 @@ void sensor_config_by_file::load_layer(sensor_table& a_table, const tabree::KTre
 
 void sensor_config_by_file::add_sensor(sensor_table& a_table, const tabree::KTree& a_node, sensor_config_by_file::context a_context)
 {
-    int t_number = sensor_table::create_unique_number();
     vector<string> t_name_chain(a_context.f_name.begin(), a_context.f_name.end());
     vector<string> t_label_chain(a_context.f_label.begin(), a_context.f_label.end());
-    sensor t_sensor(t_number, t_name_chain, t_label_chain);
-
-    t_sensor.set_calibration(a_node["default_calibration"]);
+    string t_calibration = a_node["default_calibration"].Or("");
 
     map<string, string> t_options;
     // this step is to allow overriding //
     for (auto& t_opt: a_context.f_opts) {
         t_options[t_opt.first] = t_opt.second;
     }
+    
+    f_versions[t_name_chain].push_back({a_context.f_valid_from, a_context.f_valid_to, t_calibration, t_options});
+    if (! a_context.f_is_current) {
+        return;
+    }
+    
+    // versions valid at the same time (e.g., a default and an override) make one sensor; see attach_versions() //
+    const sensor& t_existing = a_table[name_chain(t_name_chain)];
+    int t_number = t_existing ? t_existing.get_number() : sensor_table::create_unique_number();
+    sensor t_sensor(t_number, t_name_chain, t_label_chain);
+
+    t_sensor.set_calibration(t_calibration);
+    t_sensor.set_calibration_cache(a_node["calibration_cache"].Or(""));
     for (auto& t_opt: t_options) {
         t_sensor.set_option(t_opt.first, t_opt.second);
     }
@@ -214,6 +620,159 @@ void sensor_config_by_file::add_sensor(sensor_table& a_table, const tabree::KTre
     a_table.add(t_sensor);
 }
 
+const sensor_config_by_file::guard& sensor_config_by_file::evaluate_guard(const string& a_condition)
+{
+    // templated tables repeat the same conditions many times; each is parsed and evaluated once //
+    auto iter = f_guard_cache.find(a_condition);
+    if (iter != f_guard_cache.end()) {
+        return iter->second;
+    }
+    guard& t_guard = f_guard_cache[a_condition];
+    
+    static const regex t_date_pattern("(^|[^a-zA-Z0-9_])date($|[^a-zA-Z0-9_])");
+    t_guard.f_is_date_dependent = ! std::isnan(f_current_time) && regex_search(a_condition, t_date_pattern);
+    try {
+        kebap::KPEvaluator f(a_condition);
+        auto t_variables = f.Bind(*f_variable_set);
+        for (unsigned k = 0; k < t_variables.size(); k++) {
+            t_variables[k] = f_variables[k].second;
+        }
+        if (t_guard.f_is_date_dependent) {
+            t_guard.f_intervals = find_validity(f, a_condition);
+        }
+        else {
+            t_guard.f_value = f(0);  //... TODO: implement evaluator with no parameter
+        }
+    }
+    catch (kebap::KPException &e) {
+        t_guard.f_error = e.what();
+    }
+
+    return t_guard;
+}
+
+vector<pair<double, double>> sensor_config_by_file::find_validity(kebap::KPEvaluator& a_guard, const string& a_condition)
+{
+    // The guard is evaluated at each segment divided by the dates appearing in the condition //
+    // (and the following days, for the "date > YYYYMMDD" type conditions).                     //
+    set<double> t_boundary_set;
+    static const regex t_literal_pattern("[0-9]{8}");
+    for (sregex_iterator iter(a_condition.begin(), a_condition.end(), t_literal_pattern); iter != sregex_iterator(); ++iter) {
+        double t_time = timestamp_of_date(stol(iter->str()));
+        if (! std::isnan(t_time)) {
+            t_boundary_set.insert(t_time);
+            t_boundary_set.insert(t_time + 86400);
+        }
+    }
+    vector<double> t_boundaries(t_boundary_set.begin(), t_boundary_set.end());
+    
+    const double t_inf = std::numeric_limits<double>::infinity();
+    vector<pair<double, double>> t_intervals;
+    auto t_date = a_guard["date"];
+    for (unsigned i = 0; i <= t_boundaries.size(); i++) {
+        double t_from = (i == 0) ? -t_inf : t_boundaries[i-1];
+        double t_to = (i == t_boundaries.size()) ? +t_inf : t_boundaries[i];
+        double t_probe = (i > 0) ? t_from : (t_boundaries.empty() ? f_current_time : t_to - 86400);
+        t_date = date_of_timestamp(t_probe);
+        if (! a_guard(0)) {
+            continue;
+        }
+        if (! t_intervals.empty() && (t_intervals.back().second == t_from)) {
+            t_intervals.back().second = t_to;
+        }
+        else {
+            t_intervals.emplace_back(t_from, t_to);
+        }
+    }
+
+    return t_intervals;
+}
+
+static vector<sensor_version> clip_overlapping_versions(const vector<sensor_version>& a_versions, const string& a_name)
+{
+    // Versions can overlap, e.g., an unguarded default (valid forever) and a date-guarded override. //
+    // The narrower one takes precedence, and the broader one is clipped around it.                    //
+    auto width_of = [](const sensor_version& v) {
+        int t_infinite_ends = std::isinf(v.f_start) + std::isinf(v.f_stop);
+        return make_pair(t_infinite_ends, t_infinite_ends ? 0 : v.f_stop - v.f_start);
+    };
+    vector<const sensor_version*> t_by_width;
+    for (const auto& t_version: a_versions) {
+        t_by_width.push_back(&t_version);
+    }
+    std::stable_sort(t_by_width.begin(), t_by_width.end(), [&](const sensor_version* a, const sensor_version* b) {
+        return width_of(*a) < width_of(*b);
+    });
+    
+    vector<sensor_version> t_resolved;
+    for (const sensor_version* t_version: t_by_width) {
+        vector<pair<double, double>> t_pieces = {{ t_version->f_start, t_version->f_stop }}, t_remaining;
+        for (const auto& t_taken: t_resolved) {
+            t_remaining.clear();
+            for (const auto& t_piece: t_pieces) {
+                if ((t_piece.second <= t_taken.f_start) || (t_taken.f_stop <= t_piece.first)) {
+                    t_remaining.push_back(t_piece);
+                    continue;
+                }
+                if (width_of(t_taken) == width_of(*t_version)) {
+                    hERROR(cerr << "overlapping versions of the same width: " << a_name << ": the first one is used" << endl);
+                }
+                if (t_piece.first < t_taken.f_start) {
+                    t_remaining.emplace_back(t_piece.first, t_taken.f_start);
+                }
+                if (t_taken.f_stop < t_piece.second) {
+                    t_remaining.emplace_back(t_taken.f_stop, t_piece.second);
+                }
+            }
+            t_pieces.swap(t_remaining);
+        }
+        for (const auto& t_piece: t_pieces) {
+            t_resolved.push_back({ t_piece.first, t_piece.second, t_version->f_calibration, t_version->f_options });
+        }
+    }
+    std::sort(t_resolved.begin(), t_resolved.end(), [](const sensor_version& a, const sensor_version& b) {
+        return a.f_start < b.f_start;
+    });
+    
+    return t_resolved;
+}
+
+void sensor_config_by_file::attach_versions(sensor_table& a_table)
+{
+    for (auto& t_entry: f_versions) {
+        auto& t_versions = t_entry.second;
+        bool t_has_variations = false;
+        for (const auto& t_version: t_versions) {
+            t_has_variations |= (t_version.f_calibration != t_versions.front().f_calibration);
+            t_has_variations |= (t_version.f_options != t_versions.front().f_options);
+        }
+        if (! t_has_variations) {
+            continue;
+        }
+        sensor t_sensor = a_table[name_chain(t_entry.first)];
+        if (! t_sensor) {
+            continue;
+        }
+        auto t_resolved = clip_overlapping_versions(t_versions, t_sensor.get_name().join("."));
+        for (const auto& t_version: t_resolved) {
+            if ((t_version.f_start <= f_current_time) && (f_current_time < t_version.f_stop)) {
+                // the current calibration and options follow the clipped versions //
+                sensor t_current(t_sensor.get_number(), t_sensor.get_name(), t_sensor.get_label());
+                t_current.set_calibration(t_version.f_calibration);
+                t_current.set_calibration_cache(t_sensor.get_calibration_cache());
+                for (const auto& t_opt: t_version.f_options) {
+                    t_current.set_option(t_opt.first, t_opt.second);
+                }
+                t_sensor = t_current;
+                break;
+            }
+        }
+        t_sensor.set_versions(t_resolved);
+        a_table.add(t_sensor);
+    }
+    f_versions.clear();
+}
+
 
 
 void sensor_config_by_names::set_delimiters(const string& a_input_delimiters, const string& a_output_delimiter)
@@ -222,6 +781,16 @@ void sensor_config_by_names::set_delimiters(const string& a_input_delimiters, co
     f_output_delimiter = a_output_delimiter;
 }
 
+bool sensor_config_by_names::is_excluded(const sensor& a_sensor) const
+{
+    if (f_data_source.empty()) {
+        return false;
+    }
+    string t_data_source = a_sensor.get_option("data_source", "");
+    
+    return ! t_data_source.empty() && (t_data_source != f_data_source);
+}
+
 void sensor_config_by_names::load(sensor_table& a_table, const vector<string>& a_name_list, name_chain a_basename)
 {
     hINFO(cerr << "Sensor ID matching or creation" << endl);
@@ -234,13 +803,29 @@ void sensor_config_by_names::load(sensor_table& a_table, const vector<string>& a
     if (! f_name_space.empty()) {
         for (int t_number: a_table.find_like({{}})) {
              const sensor& t_sensor = a_table[t_number];
+             if (is_excluded(t_sensor)) {
+                 continue;
+             }
              string t_endpoint = t_sensor.get_option(f_name_space, "");
              if (! t_endpoint.empty()) {
                  t_binding[t_endpoint] = t_sensor.get_name().join(f_output_delimiter);
              }
+             // names bound in other periods are taken by this sensor as well //
+             for (const auto& t_version: t_sensor.get_versions()) {
+                 auto iter = t_version.f_options.find(f_name_space);
+                 if (iter != t_version.f_options.end()) {
+                     t_binding.emplace(iter->second, t_sensor.get_name().join(f_output_delimiter));
+                 }
+             }
         }
     }
 
+    // All the names are resolved against the table as given, and the results are applied at the end, //
+    // so that a sensor created for one name does not capture other names by loose matching.         //
+    vector<pair<int, string>> t_inferred_list;  // (sensor number, name)
+    vector<sensor> t_created_list;
+    map<vector<int>, unsigned> t_created_index;  // name tokens => index in t_created_list
+    
     for (const string& t_name: a_name_list) {
         // explicit matching
         auto t_explicit_iter = t_binding.find(t_name);
@@ -249,19 +834,34 @@ void sensor_config_by_names::load(sensor_table& a_table, const vector<string>& a
             continue;
         }
         
-        // inference by loose matching
-        vector<string> t_chain = name_chain{t_name, f_input_delimiters}.get_chain();
-        t_chain.insert(t_chain.end(), a_basename.get_chain().begin(), a_basename.get_chain().end());
+        name_chain t_chain(t_name, f_input_delimiters);
+        t_chain.append(a_basename);
 
-        sensor t_sensor;
+        // same name as one created above (names differing only in the delimiters)
+        auto t_created_iter = t_created_index.find(t_chain.get_tokens());
+        if (t_created_iter != t_created_index.end()) {
+            sensor& t_sensor = t_created_list[t_created_iter->second];
+            hINFO(cerr << "    Inferred: " << t_name << " => " << t_sensor.get_name().join(f_output_delimiter) << endl);
+            if (! f_name_space.empty()) {
+                t_sensor.set_option(f_name_space, t_name);
+            }
+            continue;
+        }
+        
+        // inference by loose matching
         auto t_sensor_matches = a_table.find_like(t_chain);
+        t_sensor_matches.erase(
+            std::remove_if(t_sensor_matches.begin(), t_sensor_matches.end(), [&](int a_number) { return is_excluded(a_table[a_number]); }),
+            t_sensor_matches.end()
+        );
         if (t_sensor_matches.size() == 1) {
-            t_sensor = a_table[t_sensor_matches.front()];
-            hINFO(cerr << "    Inferred: " << t_name << " => " << t_sensor.get_name().join(f_output_delimiter) << endl);
+            hINFO(cerr << "    Inferred: " << t_name << " => " << a_table[t_sensor_matches.front()].get_name().join(f_output_delimiter) << endl);
+            t_inferred_list.emplace_back(t_sensor_matches.front(), t_name);
+            continue;
         }
 
         // non-unique matching, error, skipped
-        else if (t_sensor_matches.size() > 1) {
+        if (t_sensor_matches.size() > 1) {
             hERROR(cerr << "    Mutiple possibilities on binding: " << t_name << ": " << endl);
             for (auto& s: t_sensor_matches) {
                 hERROR(cerr << "        " << a_table[s].get_name().join(f_output_delimiter) << endl);
@@ -271,14 +871,37 @@ void sensor_config_by_names::load(sensor_table& a_table, const vector<string>& a
         }
 
         // create a new sensor entry
-        if (! t_sensor) {
-            auto t_number = a_table.create_unique_number();
-            t_sensor = sensor{t_number, t_chain, t_chain};
-            hINFO(cerr << "    Created: " << t_name << " => " << t_sensor.get_name().join(f_output_delimiter) << endl);
-        }
+        auto t_number = a_table.create_unique_number();
+        sensor t_sensor{t_number, t_chain, t_chain};
+        hINFO(cerr << "    Created: " << t_name << " => " << t_sensor.get_name().join(f_output_delimiter) << endl);
         if (! f_name_space.empty()) {
             t_sensor.set_option(f_name_space, t_name);
         }
+        if (! f_data_source.empty()) {
+            t_sensor.set_option("data_source", f_data_source);
+        }
+        t_created_index.emplace(t_chain.get_tokens(), t_created_list.size());
+        t_created_list.push_back(std::move(t_sensor));
+    }
+
+    // each sensor is updated once, even if several names are inferred to it (the last one is taken) //
+    map<int, sensor> t_updated_list;
+    for (const auto& t_inferred: t_inferred_list) {
+        auto iter = t_updated_list.find(t_inferred.first);
+        if (iter == t_updated_list.end()) {
+            iter = t_updated_list.emplace(t_inferred.first, a_table[t_inferred.first]).first;
+        }
+        if (! f_name_space.empty()) {
+            iter->second.set_option(f_name_space, t_inferred.second);
+        }
+        if (! f_data_source.empty()) {
+            iter->second.set_option("data_source", f_data_source);
+        }
+    }
+    for (const auto& t_entry: t_updated_list) {
+        a_table.add(t_entry.second);
+    }
+    for (const auto& t_sensor: t_created_list) {
         a_table.add(t_sensor);
     }
 }
@@ -13,17 +13,93 @@
 #include <deque>
 #include <map>
 #include <unordered_map>
+#include <limits>
+#include <algorithm>
+#include <memory>
+#include <regex>
 #include <tabree/KTree.h>
 
+namespace kebap {
+    class KPEvaluator;
+    class KPVariableSet;
+}
+
 
 namespace honeybee {
     using namespace std;
     
+    // global table of name tokens; name chains hold token IDs, not strings //
+    // tokens are never removed, so names from queries are only looked up   //
+    class name_token_table {
+      public:
+        static int intern(const string& a_name);
+        static int find(const string& a_name);  // e_unknown if not interned
+        static const string& name_of(int a_token);  // lock-free; "" for e_unknown
+        enum { e_empty = 0, e_unknown = -1 };  // tokens of "" and of names never interned
+    };
+    
+    
     class name_chain {
       public:
         name_chain() {}
-        name_chain(const vector<string>& a_chain): f_chain(a_chain) {}
-        name_chain(string a_joined, string a_sep) {
+        name_chain(const vector<string>& a_chain) {
+            for (const string& t_name: a_chain) {
+                f_tokens.push_back(name_token_table::intern(t_name));
+            }
+        }
+        name_chain(const string& a_joined, const string& a_sep) {
+            for (const string& t_name: split(a_joined, a_sep)) {
+                f_tokens.push_back(name_token_table::intern(t_name));
+            }
+        }
+        // for queries: nodes not in the token table become e_unknown, which matches no sensor //
+        static name_chain lookup(const string& a_joined, const string& a_sep) {
+            name_chain t_chain;
+            for (const string& t_name: split(a_joined, a_sep)) {
+                t_chain.f_tokens.push_back(name_token_table::find(t_name));
+            }
+            return t_chain;
+        }
+        inline const string& operator[](int index) const {
+            while (index < 0) index += f_tokens.size();
+            return name_token_table::name_of(f_tokens[index % f_tokens.size()]);
+        }
+        inline void set(int index, const string& a_name) {
+            while (index < 0) index += f_tokens.size();
+            f_tokens[index % f_tokens.size()] = name_token_table::intern(a_name);
+        }
+        inline unsigned size() const {
+            return f_tokens.size();
+        }
+        inline name_chain& append(const name_chain& a_chain) {
+            f_tokens.insert(f_tokens.end(), a_chain.f_tokens.begin(), a_chain.f_tokens.end());
+            return *this;
+        }
+        inline const vector<int>& get_tokens() const { return f_tokens; }
+        vector<string> get_chain() const {
+            vector<string> t_chain;
+            for (int t_token: f_tokens) {
+                t_chain.push_back(name_token_table::name_of(t_token));
+            }
+            return t_chain;
+        }
+        string join(const string& a_sep=".", bool a_collapse_empty=true) const {
+            string t_joined;
+            for (unsigned i = 0; i < f_tokens.size(); i++) {
+                if (a_collapse_empty && (f_tokens[i] == name_token_table::e_empty)) {
+                    continue;
+                }
+                const string& t_name = name_token_table::name_of(f_tokens[i]);
+                t_joined += (i == 0) ? t_name : (a_sep + t_name);
+            }
+            return t_joined;
+        }
+        inline bool operator==(const name_chain& a_chain) const { return f_tokens == a_chain.f_tokens; }
+        inline bool operator!=(const name_chain& a_chain) const { return f_tokens != a_chain.f_tokens; }
+      protected:
+        static vector<string> split(string a_joined, const string& a_sep) {
+            // split by the first separator found in the string //
+            vector<string> t_names;
             for (char t_sep: a_sep) {
                 auto t_end = a_joined.find_first_of(t_sep);
                 if (t_end == string::npos) {
@@ -31,7 +107,7 @@ namespace honeybee {
                 }
                 while (true) {
                     t_end = a_joined.find_first_of(t_sep);
-                    f_chain.push_back(a_joined.substr(0, t_end));
+                    t_names.push_back(a_joined.substr(0, t_end));
                     if (t_end == string::npos) {
                         break;
                     }
@@ -39,37 +115,24 @@ namespace honeybee {
                 }
                 break;
             }
-            if (f_chain.empty() && ! a_joined.empty()) {
-                f_chain.push_back(a_joined);
+            if (t_names.empty() && ! a_joined.empty()) {
+                t_names.push_back(a_joined);
             }
-        }
-        inline const string& operator[](int index) const {
-            while (index < 0) index += f_chain.size();
-            return f_chain[index % f_chain.size()];
-        }
-        inline string& operator[](int index) {
-            return const_cast<string&>(static_cast<const name_chain*>(this)->operator[](index));
-        }
-        inline unsigned size() const {
-            return f_chain.size();
-        }
-        inline const vector<string>& get_chain() const { return f_chain; }
-        inline vector<string>& get_chain() { return f_chain; }
-        string join(const string& a_sep=".", bool a_collapse_empty=true) const {
-            string t_joined;
-            for (unsigned i = 0; i < f_chain.size(); i++) {
-                if (a_collapse_empty && f_chain[i].empty()) {
-                    continue;
-                }
-                t_joined += (i == 0) ? f_chain[i] : (a_sep + f_chain[i]);
-            }
-            return t_joined;
+            return t_names;
         }
       protected:
-        vector<string> f_chain;
+        vector<int> f_tokens;
     };
 
 
+    // variant of a sensor for a limited period, from a date-dependent valid_if block //
+    struct sensor_version {
+        double f_start, f_stop;  // validity: [start, stop) in UNIX time
+        string f_calibration;
+        map<string, string> f_options;  // bindings (dripline_endpoint etc) and other options
+    };
+
+    
     class sensor {
       public:
         sensor(): f_number(0), f_name(), f_label() {}
@@ -81,6 +144,10 @@ namespace honeybee {
         inline const name_chain& get_name() const { return f_name; }
         inline const name_chain& get_label() const { return f_label; }
         inline const string& get_calibration() const { return f_calibration; }
+        inline const string& get_calibration_cache() const { return f_calibration_cache; }
+        inline const vector<sensor_version>& get_versions() const { return f_versions; }  // sorted, non-overlapping
+        bool has_calibration_versions() const;
+        inline const map<string, string>& get_options() const { return f_options; }
         inline string get_option(const string& name, const string& default_value="") const {
             auto iter = f_options.find(name);
             return (iter == f_options.end()) ? default_value : iter->second;
@@ -89,15 +156,35 @@ namespace honeybee {
       public:
         // used by sensor_config
         void set_calibration(const string& calibration) { f_calibration = calibration; }
+        void set_calibration_cache(const string& cache) { f_calibration_cache = cache; }
+        void set_versions(const vector<sensor_version>& versions) { f_versions = versions; }
         void set_option(const string& name, const string& value) { f_options[name] = value; }
       protected:
         int f_number;
         name_chain f_name;
         name_chain f_label;
         string f_calibration;
+        string f_calibration_cache;
+        vector<sensor_version> f_versions;
         map<string, string> f_options;
     };
 
+
+    // sensor selection by a pattern, compiled once:
+    //   glob for each node, matched in order as in find_like():  degC.RTD*.Acc
+    //   regular expression searched in the joined name:          re:^degC\.RTD[0-9]+\.
+    class sensor_pattern {
+      public:
+        sensor_pattern(const string& a_pattern, const string& a_delimiters=".", const string& a_joint=".");
+        static bool is_pattern(const string& a_text);
+        inline const string& get_text() const { return f_text; }
+      protected:
+        string f_text, f_joint;
+        vector<string> f_node_patterns;
+        shared_ptr<regex> f_regex;
+        friend class sensor_table;
+    };
+
     
     class sensor_table {
       public:
@@ -110,7 +197,9 @@ namespace honeybee {
             return iter->second;
         }
         inline const sensor& operator[](const name_chain& a_name) const {
-            auto iter = f_reverse_table.find(a_name.join(f_internal_separator));
+            const auto& t_tokens = a_name.get_tokens();
+            bool t_has_empty = std::find(t_tokens.begin(), t_tokens.end(), int(name_token_table::e_empty)) != t_tokens.end();
+            auto iter = t_has_empty ? f_reverse_table.find(reverse_key(a_name)) : f_reverse_table.find(t_tokens);
             if (iter == f_reverse_table.end()) {
                 return f_null_sensor;
             }
@@ -118,19 +207,28 @@ namespace honeybee {
         }
         vector<int> find_like(const name_chain& a_chain) const;
         int find_one_like(const name_chain& a_chain) const;
+        vector<int> find_matching(const sensor_pattern& a_pattern) const;
       public:
-        void add(const sensor& a_sensor) {
-            f_table[a_sensor.get_number()] = a_sensor;
-            f_reverse_table[a_sensor.get_name().join(f_internal_separator)] = a_sensor.get_number();
-        }
+        void add(const sensor& a_sensor);
         static int create_unique_number(void) {
             return 0x10000000 + f_unique_sequence++;
         }
+      protected:
+        struct token_list_hash {
+            size_t operator()(const vector<int>& a_tokens) const {
+                size_t t_hash = a_tokens.size();
+                for (int t_token: a_tokens) {
+                    t_hash ^= std::hash<int>()(t_token) + 0x9e3779b9 + (t_hash << 6) + (t_hash >> 2);
+                }
+                return t_hash;
+            }
+        };
+        static vector<int> reverse_key(const name_chain& a_name);  // tokens, with empty nodes collapsed as in join()
       protected:
         sensor f_null_sensor;
-        string f_internal_separator = "\t";
         map<int, sensor> f_table;
-        unordered_map<string, int> f_reverse_table;
+        unordered_map<vector<int>, int, token_list_hash> f_reverse_table;
+        vector<vector<int>> f_node_index;  // name token => sorted sensor numbers
         static int f_unique_sequence;
     };
 
@@ -147,11 +245,29 @@ namespace honeybee {
         struct context {
             deque<string> f_name, f_label;
             deque<pair<string, string>> f_opts;
+            double f_valid_from = -std::numeric_limits<double>::infinity();
+            double f_valid_to = +std::numeric_limits<double>::infinity();
+            bool f_is_current = true;  // valid at the time given by the "date" variable
         };
         void load_layer(sensor_table& a_table, const tabree::KTree& a_node, context a_context);
         void add_sensor(sensor_table& a_table, const tabree::KTree& a_node, context a_context);
+        vector<pair<double, double>> find_validity(kebap::KPEvaluator& a_guard, const string& a_condition);
+        void attach_versions(sensor_table& a_table);
+      protected:
+        // outcome of a valid_if condition; depends only on the text while the variables are fixed //
+        struct guard {
+            bool f_is_date_dependent = false;
+            bool f_value = true;
+            vector<pair<double, double>> f_intervals;  // validity periods, for date-dependent guards
+            string f_error;
+        };
+        const guard& evaluate_guard(const string& a_condition);
       protected:
         variables f_variables;
+        shared_ptr<kebap::KPVariableSet> f_variable_set;  // f_variables names, resolved for the guard evaluators
+        double f_current_time;  // time given by the "date" variable, NaN if undefined
+        map<vector<string>, vector<sensor_version>> f_versions;
+        unordered_map<string, guard> f_guard_cache;  // condition text => guard, cleared at each load()
     };
 
 
@@ -160,9 +276,15 @@ namespace honeybee {
       public:
         sensor_config_by_names(const string& a_name_space=""): f_name_space(a_name_space), f_input_delimiters("/.-_"), f_output_delimiter(".") {}
         void set_delimiters(const string& a_delimiters, const string& f_output_delimiter);
+        // for one of federated data sources: sensors with the option "data_source" naming another are not matched,
+        // and the sensors matched or created are given the option with this name
+        void set_data_source(const string& a_data_source) { f_data_source = a_data_source; }
         void load(sensor_table& a_table, const vector<string>& a_name_list, name_chain a_basename=name_chain());
+      protected:
+        bool is_excluded(const sensor& a_sensor) const;
       protected:
         string f_name_space;  // "dripline_endpoint" etc
+        string f_data_source;
         vector<string> f_basenames;
         string f_input_delimiters, f_output_delimiter;
     };
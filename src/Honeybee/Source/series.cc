@@ -12,6 +12,8 @@
 #include <algorithm>
 #include <numeric>
 #include <cmath>
+#include <cstdlib>
+#include <stdexcept>
 #include "utils.hh"
 #include "series.hh"
 
@@ -153,6 +155,33 @@ double reduce_to_middle(const series& a_series)
     return x0;
 }
 
+std::vector<double> reduce_to_envelope(const series& a_series)
+{
+    // min and max, in the order of occurrence, so that a line through them follows the data //
+    auto& x = a_series.x();
+    int k_min = -1, k_max = -1;
+    for (unsigned k = 0; k < x.size(); k++) {
+        if (std::isnan(x[k])) {
+            continue;
+        }
+        if ((k_min < 0) || (x[k] < x[k_min])) {
+            k_min = k;
+        }
+        if ((k_max < 0) || (x[k] > x[k_max])) {
+            k_max = k;
+        }
+    }
+    if (k_min < 0) {
+        return { NaN, NaN };
+    }
+    if (k_min <= k_max) {
+        return { x[k_min], x[k_max] };
+    }
+    else {
+        return { x[k_max], x[k_min] };
+    }
+}
+
 series dropna(const series& a_series)
 {
     return a_series.filter([](double xk)->bool{ return ! std::isnan(xk); });
@@ -306,6 +335,102 @@ series slice::operator()(const series& a_series)
     return t_series;
 }
 
+downsample_lttb::downsample_lttb(unsigned a_number_of_points)
+: f_number_of_points(a_number_of_points)
+{
+}
+
+series downsample_lttb::operator()(const series& a_series)
+{
+    series t_input = dropna(a_series);
+    unsigned n = f_number_of_points;
+    if ((n < 3) || (n >= t_input.size())) {
+        return t_input;
+    }
+    
+    // times from the first point, to keep the triangle areas precise //
+    const auto& x = t_input.x();
+    vector<double> t(t_input.t());
+    double t0 = t[0];
+    for (auto& tk: t) {
+        tk -= t0;
+    }
+
+    // first and last points as they are, one point from each of the n-2 buckets in between //
+    series t_series(a_series.get_start(), a_series.get_stop());
+    t_series.emplace_back(t_input.t()[0], x[0]);
+    const double t_bucket_size = double(t.size() - 2) / (n - 2);
+    unsigned a = 0;
+    for (unsigned i = 0; i < n - 2; i++) {
+        unsigned t_begin = unsigned(i * t_bucket_size) + 1;
+        unsigned t_end = unsigned((i + 1) * t_bucket_size) + 1;
+        
+        // the third vertex: average of the next bucket, or the last point //
+        unsigned t_next_begin = t_end;
+        unsigned t_next_end = std::min<unsigned>(unsigned((i + 2) * t_bucket_size) + 1, t.size());
+        double t_avg = 0, x_avg = 0;
+        for (unsigned k = t_next_begin; k < t_next_end; k++) {
+            t_avg += t[k];
+            x_avg += x[k];
+        }
+        t_avg /= (t_next_end - t_next_begin);
+        x_avg /= (t_next_end - t_next_begin);
+
+        unsigned t_selected = t_begin;
+        double t_max_area = -1;
+        for (unsigned k = t_begin; k < t_end; k++) {
+            double t_area = fabs((t[a] - t_avg) * (x[k] - x[a]) - (t[a] - t[k]) * (x_avg - x[a]));
+            if (t_area > t_max_area) {
+                t_max_area = t_area;
+                t_selected = k;
+            }
+        }
+        t_series.emplace_back(t_input.t()[t_selected], x[t_selected]);
+        a = t_selected;
+    }
+    t_series.emplace_back(t_input.t().back(), x.back());
+    
+    return t_series;
+}
+
+downsampling_spec::downsampling_spec(const string& a_reducer)
+: f_method(a_reducer.substr(0, a_reducer.find(':'))), f_number_of_points(0)
+{
+    if ((f_method != "minmax") && (f_method != "lttb")) {
+        f_method.clear();
+        return;
+    }
+    if (a_reducer.find(':') == string::npos) {
+        return;
+    }
+    
+    string t_points = a_reducer.substr(a_reducer.find(':') + 1);
+    long t_min_points = (f_method == "minmax") ? 2 : 3;
+    char* t_end = nullptr;
+    long t_value = strtol(t_points.c_str(), &t_end, 10);
+    if (t_points.empty() || (*t_end != '\0') || (t_value < t_min_points)) {
+        throw std::invalid_argument("bad number of points (minmax: 2 or more, lttb: 3 or more): " + a_reducer);
+    }
+    f_number_of_points = t_value;
+}
+
+unsigned downsampling_spec::get_lttb_points(double a_from, double a_to, double a_interval) const
+{
+    if (f_number_of_points > 0) {
+        return f_number_of_points;
+    }
+    return (a_interval > 0) ? unsigned(ceil((a_to - a_from) / a_interval)) : 1000;
+}
+
+double downsampling_spec::get_minmax_step(double a_from, double a_to, double a_interval) const
+{
+    if (a_interval > 0) {
+        return a_interval;
+    }
+    unsigned t_number_of_points = (f_number_of_points > 0) ? f_number_of_points : 1000;
+    return (a_to - a_from) / (t_number_of_points / 2);
+}
+
 
 time_grouper::time_grouper(double a_step)
 : f_step(a_step), f_offset(0), f_start(NaN), f_stop(NaN)
@@ -521,7 +646,16 @@ series resampler::operator()(const series& a_series)
         }
         series t_slice = a_series.apply(slice(t_range.begin, t_range.end));
         t_slice.set_span(t_range.t-t_range.dt/2, t_range.t+t_range.dt/2);
-        t_series.emplace_back(t_range.t, f_reducer(std::move(t_slice)));
+        if (f_multi_reducer) {
+            // points evenly placed in the group //
+            vector<double> t_values = f_multi_reducer(std::move(t_slice));
+            for (unsigned k = 0; k < t_values.size(); k++) {
+                t_series.emplace_back(t_range.t - t_range.dt/2 + (k+0.5) * t_range.dt / t_values.size(), t_values[k]);
+            }
+        }
+        else {
+            t_series.emplace_back(t_range.t, f_reducer(std::move(t_slice)));
+        }
     }
 
     t_series.apply_inplace(f_filler);
@@ -178,12 +178,15 @@ namespace honeybee {
     extern double reduce_to_first(const series& a_series);
     extern double reduce_to_last(const series& a_series);
     extern double reduce_to_middle(const series& a_series);
+    // multi-point reducer for resampler: min and max in the order of occurrence (envelope for plotting) //
+    extern std::vector<double> reduce_to_envelope(const series& a_series);
     
     //// Series-applicable functors (transform) ////
     // example usages:
     //   auto t_series_2 = t_series.apply(dropna);
     //   auto t_series_2 = t_series.apply_inplace(fillna_with_prev).apply_inplace(fillna_with(0));
     //   auto t_series_2 = t_series.apply(slice(10, 20));
+    //   auto t_series_2 = t_series.apply(downsample_lttb(2000));
     
     extern series dropna(const series& a_series);
     extern series& keepna(series& a_series);
@@ -206,12 +209,35 @@ namespace honeybee {
       protected:
         unsigned f_from, f_to;
     };
+    // Largest-Triangle-Three-Buckets: picks the given number of points that keep the visual shape (NaN dropped) //
+    class downsample_lttb {
+      public:
+        downsample_lttb(unsigned a_number_of_points);
+        series operator()(const series& a_series);
+      protected:
+        unsigned f_number_of_points;
+    };
+    // Plot-oriented downsampling given as a resampling reducer, "minmax[:POINTS]" or "lttb[:POINTS]" //
+    // (the method is empty for the other reducers); std::invalid_argument for a bad POINTS        //
+    class downsampling_spec {
+      public:
+        downsampling_spec(const std::string& a_reducer="");
+        const std::string& get_method() const { return f_method; }
+        // POINTS, or the range divided by the interval, or 1000 for the auto interval (a_interval <= 0) //
+        unsigned get_lttb_points(double a_from, double a_to, double a_interval) const;
+        // the interval, or for POINTS (default 1000) over the range with the auto interval; two points per group //
+        double get_minmax_step(double a_from, double a_to, double a_interval) const;
+      protected:
+        std::string f_method;
+        unsigned f_number_of_points;  // 0 if not given
+    };
 
     
     //// Resampler (Series-applicable functor) ////
     // example usages:
     //   resampler t_resampler(group_by_time(t_resampling_interval), reduce_to_first, keepna)
     //   resampler t_resampler(group_to_align(t_series0), reduce_to_mean, fillna_with(-1))
+    //   resampler t_resampler(group_by_time(t_resampling_interval), reduce_to_envelope)  // two points per group
     //   auto t_series_2 = t_series.apply(resampler);
     
     using series_bundle = hb::zipped_table<std::vector<std::string>, std::vector<hb::series>>;
@@ -228,14 +254,17 @@ namespace honeybee {
             virtual group_index next() = 0;
         };
         using reducer = std::function<double(const series&)>;
+        using multi_reducer = std::function<std::vector<double>(const series&)>;  // a fixed number of points per group
         using filler = std::function<series&(series&)>;
       public:
         resampler(std::shared_ptr<grouper> a_grouper, reducer a_reducer, filler a_filler=keepna): f_grouper(a_grouper), f_reducer(a_reducer), f_filler(a_filler) {}
-        resampler(const resampler& a_resampler): f_grouper(a_resampler.f_grouper), f_reducer(a_resampler.f_reducer), f_filler(a_resampler.f_filler) {}
+        resampler(std::shared_ptr<grouper> a_grouper, multi_reducer a_reducer, filler a_filler=keepna): f_grouper(a_grouper), f_multi_reducer(a_reducer), f_filler(a_filler) {}
+        resampler(const resampler& a_resampler): f_grouper(a_resampler.f_grouper), f_reducer(a_resampler.f_reducer), f_multi_reducer(a_resampler.f_multi_reducer), f_filler(a_resampler.f_filler) {}
         series operator()(const series& a_series);
       protected:
         std::shared_ptr<grouper> f_grouper;
         reducer f_reducer;
+        multi_reducer f_multi_reducer;
         filler f_filler;
     };
     
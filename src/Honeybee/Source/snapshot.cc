@@ -0,0 +1,337 @@
+/*
+ * snapshot.cc
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sanshiro Enomoto <sanshiro@uw.edu>
+ */
+
+#include <string>
+#include <vector>
+#include <map>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "utils.hh"
+#include "snapshot.hh"
+
+using namespace std;
+using namespace honeybee;
+
+
+static const char g_snapshot_magic[8] = { 'H', 'B', 'S', 'N', 'A', 'P', 0, 4 };
+static const char g_metadata_cache_magic[8] = { 'H', 'B', 'M', 'E', 'T', 'A', 0, 1 };
+
+
+namespace {
+    class snapshot_writer {
+      public:
+        void put_u32(uint32_t a_value) { f_buffer.append((const char*) &a_value, sizeof(a_value)); }
+        void put_f64(double a_value) { f_buffer.append((const char*) &a_value, sizeof(a_value)); }
+        void put_string(const string& a_value) { put_u32(a_value.size()); f_buffer.append(a_value); }
+        void put_strings(const vector<string>& a_values) {
+            put_u32(a_values.size());
+            for (const auto& t_value: a_values) {
+                put_string(t_value);
+            }
+        }
+        void put_options(const map<string, string>& a_options) {
+            put_u32(a_options.size());
+            for (const auto& t_option: a_options) {
+                put_string(t_option.first);
+                put_string(t_option.second);
+            }
+        }
+        string f_buffer;
+    };
+
+    class snapshot_reader {
+      public:
+        snapshot_reader(const char* a_data, size_t a_size): f_data(a_data), f_end(a_data + a_size) {}
+        const char* take(size_t a_size) {
+            if (size_t(f_end - f_data) < a_size) {
+                throw std::runtime_error("truncated snapshot");
+            }
+            const char* t_data = f_data;
+            f_data += a_size;
+            return t_data;
+        }
+        uint32_t get_u32() { uint32_t t_value; memcpy(&t_value, take(sizeof(t_value)), sizeof(t_value)); return t_value; }
+        double get_f64() { double t_value; memcpy(&t_value, take(sizeof(t_value)), sizeof(t_value)); return t_value; }
+        string get_string() { uint32_t t_size = get_u32(); return string(take(t_size), t_size); }
+        vector<string> get_strings() {
+            vector<string> t_values(get_u32());
+            for (auto& t_value: t_values) {
+                t_value = get_string();
+            }
+            return t_values;
+        }
+        map<string, string> get_options() {
+            map<string, string> t_options;
+            uint32_t t_size = get_u32();
+            for (uint32_t k = 0; k < t_size; k++) {
+                string t_name = get_string();
+                t_options[t_name] = get_string();
+            }
+            return t_options;
+        }
+      protected:
+        const char* f_data;
+        const char* f_end;
+    };
+}
+
+
+
+string app_snapshot::make_key(const vector<string>& a_file_list, const vector<string>& a_parameter_list)
+{
+    // FNV-1a over the format version, the file contents and the parameters //
+    uint64_t t_hash = 0xcbf29ce484222325ULL;
+    auto feed = [&](const string& a_text) {
+        for (unsigned char c: a_text) {
+            t_hash = (t_hash ^ c) * 0x100000001b3ULL;
+        }
+        t_hash = (t_hash ^ 0xff) * 0x100000001b3ULL;  // separator
+    };
+
+    feed(string(g_snapshot_magic, sizeof(g_snapshot_magic)));
+    for (const auto& t_file: a_file_list) {
+        feed(t_file);
+        ifstream t_input(t_file, ios::binary);
+        if (! t_input) {
+            return "";
+        }
+        ostringstream t_contents;
+        t_contents << t_input.rdbuf();
+        feed(t_contents.str());
+    }
+    for (const auto& t_parameter: a_parameter_list) {
+        feed(t_parameter);
+    }
+
+    ostringstream os;
+    os << hex << setw(16) << setfill('0') << t_hash;
+
+    return os.str();
+}
+
+bool app_snapshot::save(const string& a_path) const
+{
+    snapshot_writer w;
+    w.f_buffer.append(g_snapshot_magic, sizeof(g_snapshot_magic));
+    w.put_string(f_key);
+    w.put_f64(f_time);
+    w.put_string(f_input_delimiters);
+    w.put_string(f_output_delimiter);
+
+    w.put_u32(f_sensors.size());
+    for (const auto& t_sensor: f_sensors) {
+        w.put_u32(t_sensor.get_number());
+        w.put_strings(t_sensor.get_name().get_chain());
+        w.put_strings(t_sensor.get_label().get_chain());
+        w.put_string(t_sensor.get_calibration());
+        w.put_string(t_sensor.get_calibration_cache());
+        w.put_u32(t_sensor.get_versions().size());
+        for (const auto& t_version: t_sensor.get_versions()) {
+            w.put_f64(t_version.f_start);
+            w.put_f64(t_version.f_stop);
+            w.put_string(t_version.f_calibration);
+            w.put_options(t_version.f_options);
+        }
+        w.put_options(t_sensor.get_options());
+    }
+
+    w.put_string(f_db_uri_hash);
+    w.put_string(f_db_basename);
+    w.put_u32(f_db_metadata.f_has_idmap ? 1 : 0);
+    w.put_string(f_db_metadata.f_sensorname_column);
+    w.put_strings(f_db_metadata.f_data_names);
+    w.put_string(f_db_metadata.f_stamp);
+
+    // written to a temporary file and renamed, not to disturb concurrent readers //
+    string t_temporary_path = a_path + ".tmp." + to_string(getpid());
+    int t_fd = open(t_temporary_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if (t_fd < 0) {
+        hERROR(cerr << "unable to write snapshot: " << t_temporary_path << endl);
+        return false;
+    }
+    bool t_is_written = (write(t_fd, w.f_buffer.data(), w.f_buffer.size()) == (ssize_t) w.f_buffer.size());
+    close(t_fd);
+    if (! t_is_written || (rename(t_temporary_path.c_str(), a_path.c_str()) != 0)) {
+        hERROR(cerr << "unable to write snapshot: " << a_path << endl);
+        remove(t_temporary_path.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+bool app_snapshot::load(const string& a_path, const string& a_key)
+{
+    int t_fd = open(a_path.c_str(), O_RDONLY);
+    if (t_fd < 0) {
+        return false;
+    }
+    struct stat t_stat;
+    if ((fstat(t_fd, &t_stat) != 0) || (t_stat.st_size < (off_t) sizeof(g_snapshot_magic))) {
+        close(t_fd);
+        return false;
+    }
+    size_t t_size = t_stat.st_size;
+    void* t_map = mmap(nullptr, t_size, PROT_READ, MAP_PRIVATE, t_fd, 0);
+    close(t_fd);
+    if (t_map == MAP_FAILED) {
+        return false;
+    }
+
+    bool t_is_loaded = false;
+    try {
+        snapshot_reader r((const char*) t_map, t_size);
+        if (memcmp(r.take(sizeof(g_snapshot_magic)), g_snapshot_magic, sizeof(g_snapshot_magic)) != 0) {
+            throw std::runtime_error("not a snapshot file");
+        }
+        f_key = r.get_string();
+        if (f_key != a_key) {
+            throw std::runtime_error("outdated");
+        }
+        f_time = r.get_f64();
+        f_input_delimiters = r.get_string();
+        f_output_delimiter = r.get_string();
+
+        f_sensors.clear();
+        uint32_t t_number_of_sensors = r.get_u32();
+        for (uint32_t i = 0; i < t_number_of_sensors; i++) {
+            int t_number = r.get_u32();
+            name_chain t_name = r.get_strings();
+            name_chain t_label = r.get_strings();
+            sensor t_sensor(t_number, t_name, t_label);
+            t_sensor.set_calibration(r.get_string());
+            t_sensor.set_calibration_cache(r.get_string());
+            vector<sensor_version> t_versions(r.get_u32());
+            for (auto& t_version: t_versions) {
+                t_version.f_start = r.get_f64();
+                t_version.f_stop = r.get_f64();
+                t_version.f_calibration = r.get_string();
+                t_version.f_options = r.get_options();
+            }
+            t_sensor.set_versions(t_versions);
+            for (const auto& t_option: r.get_options()) {
+                t_sensor.set_option(t_option.first, t_option.second);
+            }
+            f_sensors.push_back(t_sensor);
+        }
+
+        f_db_uri_hash = r.get_string();
+        f_db_basename = r.get_string();
+        f_db_metadata.f_has_idmap = (r.get_u32() != 0);
+        f_db_metadata.f_sensorname_column = r.get_string();
+        f_db_metadata.f_data_names = r.get_strings();
+        f_db_metadata.f_stamp = r.get_string();
+
+        t_is_loaded = true;
+    }
+    catch (std::exception &e) {
+        hINFO(cerr << "snapshot not used: " << a_path << ": " << e.what() << endl);
+    }
+    munmap(t_map, t_size);
+
+    return t_is_loaded;
+}
+
+
+
+bool metadata_cache::read(map<string, entry>& a_entries)
+{
+    ifstream t_input(f_path, ios::binary);
+    if (! t_input) {
+        return false;
+    }
+    ostringstream t_contents;
+    t_contents << t_input.rdbuf();
+    string t_buffer = t_contents.str();
+    
+    try {
+        snapshot_reader r(t_buffer.data(), t_buffer.size());
+        if (memcmp(r.take(sizeof(g_metadata_cache_magic)), g_metadata_cache_magic, sizeof(g_metadata_cache_magic)) != 0) {
+            throw std::runtime_error("not a metadata cache file");
+        }
+        uint32_t t_number_of_entries = r.get_u32();
+        for (uint32_t i = 0; i < t_number_of_entries; i++) {
+            string t_key = r.get_string();
+            entry& t_entry = a_entries[t_key];
+            t_entry.f_time = r.get_f64();
+            t_entry.f_metadata.f_has_idmap = (r.get_u32() != 0);
+            t_entry.f_metadata.f_sensorname_column = r.get_string();
+            t_entry.f_metadata.f_stamp = r.get_string();
+            t_entry.f_metadata.f_data_names = r.get_strings();
+        }
+    }
+    catch (std::exception &e) {
+        hINFO(cerr << "metadata cache not used: " << f_path << ": " << e.what() << endl);
+        a_entries.clear();
+        return false;
+    }
+
+    return true;
+}
+
+bool metadata_cache::load(const string& a_db_uri, dripline_pgsql::metadata& a_metadata, double& a_age)
+{
+    map<string, entry> t_entries;
+    if (! read(t_entries)) {
+        return false;
+    }
+    auto iter = t_entries.find(app_snapshot::make_key({}, {a_db_uri}));
+    if (iter == t_entries.end()) {
+        return false;
+    }
+    a_metadata = iter->second.f_metadata;
+    a_age = (long) datetime::now() - iter->second.f_time;
+
+    return true;
+}
+
+bool metadata_cache::save(const string& a_db_uri, const dripline_pgsql::metadata& a_metadata)
+{
+    // other DBs in the file are kept; concurrent writers might drop each other's update, which is only a cache miss //
+    map<string, entry> t_entries;
+    read(t_entries);
+    entry& t_entry = t_entries[app_snapshot::make_key({}, {a_db_uri})];
+    t_entry.f_time = (long) datetime::now();
+    t_entry.f_metadata = a_metadata;
+    
+    snapshot_writer w;
+    w.f_buffer.append(g_metadata_cache_magic, sizeof(g_metadata_cache_magic));
+    w.put_u32(t_entries.size());
+    for (const auto& t_item: t_entries) {
+        w.put_string(t_item.first);
+        w.put_f64(t_item.second.f_time);
+        w.put_u32(t_item.second.f_metadata.f_has_idmap ? 1 : 0);
+        w.put_string(t_item.second.f_metadata.f_sensorname_column);
+        w.put_string(t_item.second.f_metadata.f_stamp);
+        w.put_strings(t_item.second.f_metadata.f_data_names);
+    }
+
+    string t_temporary_path = f_path + ".tmp." + to_string(getpid());
+    int t_fd = open(t_temporary_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if (t_fd < 0) {
+        hERROR(cerr << "unable to write metadata cache: " << t_temporary_path << endl);
+        return false;
+    }
+    bool t_is_written = (write(t_fd, w.f_buffer.data(), w.f_buffer.size()) == (ssize_t) w.f_buffer.size());
+    close(t_fd);
+    if (! t_is_written || (rename(t_temporary_path.c_str(), f_path.c_str()) != 0)) {
+        hERROR(cerr << "unable to write metadata cache: " << f_path << endl);
+        remove(t_temporary_path.c_str());
+        return false;
+    }
+
+    return true;
+}
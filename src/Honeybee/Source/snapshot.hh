@@ -0,0 +1,58 @@
+/*
+ * snapshot.hh
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Sanshiro Enomoto <sanshiro@uw.edu>
+ */
+
+#ifndef HONEYBEE_SNAPSHOT_HH_
+#define HONEYBEE_SNAPSHOT_HH_ 1
+
+#include <string>
+#include <vector>
+#include <map>
+#include "sensor_table.hh"
+#include "data_source.hh"
+
+
+namespace honeybee {
+    using namespace std;
+
+    // Resolved state of honeybee_app::construct() in a binary file, to skip config
+    // parsing and DB queries while the inputs (the key) are unchanged.
+    // Calibrations are stored as expressions; they are compiled at the first use.
+    // The DB end-point list in it is not covered by the key; it is checked by the stamp when older than a TTL.
+    // The DB URI is stored only as a hash, as it might contain a password; the loader takes it from the inputs.
+    class app_snapshot {
+      public:
+        static string make_key(const vector<string>& a_file_list, const vector<string>& a_parameter_list);
+        bool save(const string& a_path) const;
+        bool load(const string& a_path, const string& a_key);  // false if missing, broken or stale
+      public:
+        string f_key;
+        double f_time = 0;  // of saving, in UNIX time
+        string f_input_delimiters, f_output_delimiter;
+        vector<sensor> f_sensors;
+        string f_db_uri_hash, f_db_basename;  // hash by make_key(), empty without DB
+        dripline_pgsql::metadata f_db_metadata;
+    };
+
+
+    // Dripline DB metadata (table layout and end-point list) saved per DB, shared by processes.
+    // The DB URI is stored only as a hash, as it might contain a password.
+    class metadata_cache {
+      public:
+        metadata_cache(const string& a_path): f_path(a_path) {}
+        bool load(const string& a_db_uri, dripline_pgsql::metadata& a_metadata, double& a_age);  // age in sec
+        bool save(const string& a_db_uri, const dripline_pgsql::metadata& a_metadata);
+      protected:
+        struct entry {
+            double f_time;
+            dripline_pgsql::metadata f_metadata;
+        };
+        bool read(map<string, entry>& a_entries);
+        string f_path;
+    };
+
+}
+#endif